@@ -0,0 +1,83 @@
+#ifndef AOF_LOG_H
+#define AOF_LOG_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+class RedisCommandHandler;
+
+// Append-only file persistence.
+//
+// Mutating commands are appended (in their original RESP form) to an
+// in-memory buffer; a background sync thread flushes the buffer and
+// fsync()s once per second ("everysec" group commit), so the hot path
+// never touches the disk. replay() feeds an existing log back through
+// the command handler on startup, and rewrite() compacts the log in the
+// background by re-deriving it from the current dataset.
+class AofLog
+{
+public:
+    static AofLog &getInstance();
+
+    // Open (create) the log at path and start the sync thread.
+    // Call after replay so replayed commands are not re-appended.
+    bool enable(const std::string &path);
+
+    bool isEnabled() const
+    {
+        return enabled.load(std::memory_order_acquire);
+    }
+
+    // Queue one RESP command frame for the next group commit
+    void append(std::string_view frame);
+
+    // Write the pending buffer and fsync (called by the sync thread,
+    // on rewrite, and on shutdown)
+    void flush();
+
+    // Background compaction: re-derive the log from the live dataset.
+    // Returns false if a rewrite is already running.
+    bool rewrite();
+
+    // Replay an existing log through the command handler (startup path)
+    static bool replay(const std::string &path, RedisCommandHandler &handler);
+
+    void shutdown();
+
+private:
+    AofLog() = default;
+    ~AofLog() { shutdown(); }
+
+    AofLog(const AofLog &) = delete;
+    AofLog &operator=(const AofLog &) = delete;
+
+    void syncLoop();
+    void doRewrite();
+
+    // Auto-rewrite when the log outgrows both the floor and twice its
+    // size after the previous rewrite
+    static constexpr long long REWRITE_MIN_SIZE = 64LL * 1024 * 1024;
+
+    std::atomic<bool> enabled{false};
+    std::atomic<bool> stopping{false};
+    std::atomic<bool> rewrite_running{false};
+
+    std::string path;
+
+    std::mutex buf_mutex; // guards buffer + file handle + size counters
+    std::string buffer;
+    std::FILE *file = nullptr;
+    long long file_size = 0;
+    long long size_after_rewrite = 0;
+
+    std::thread sync_thread;
+    std::condition_variable sync_cv;
+    std::mutex sync_mutex;
+};
+
+#endif // AOF_LOG_H
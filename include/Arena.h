@@ -0,0 +1,127 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/* ============================================================
+   Request-scoped bump allocator.
+
+   Every request through splitFrames → processCommand creates a
+   handful of short-lived containers (the frame list, the token
+   vector) that all die once the response batch is sent. Carving
+   them out of a per-thread arena turns each of those mallocs
+   into a pointer bump, and freeing into a single reset() at the
+   next frame-batch boundary — no global-allocator contention
+   from the worker threads on the hot path.
+
+   Blocks are retained across reset(), so a warmed-up worker
+   allocates no new memory at all in steady state. Individual
+   deallocations are no-ops: anything carved from the arena must
+   not outlive the reset that follows its batch.
+   ============================================================ */
+class Arena
+{
+public:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    Arena() = default;
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void *allocate(size_t bytes, size_t align)
+    {
+        if (bytes == 0)
+            bytes = 1;
+
+        // Oversized requests get their own block and are returned to the
+        // system on reset, so a single huge value can't pin block memory.
+        if (bytes > BLOCK_SIZE)
+        {
+            overflow.emplace_back(new char[bytes]);
+            return overflow.back().get();
+        }
+
+        if (blocks.empty())
+            blocks.emplace_back(new char[BLOCK_SIZE]);
+
+        size_t aligned = (offset + align - 1) & ~(align - 1);
+        if (aligned + bytes > BLOCK_SIZE)
+        {
+            cur_block++;
+            if (cur_block == blocks.size())
+                blocks.emplace_back(new char[BLOCK_SIZE]);
+            aligned = 0;
+        }
+
+        void *p = blocks[cur_block].get() + aligned;
+        offset = aligned + bytes;
+        return p;
+    }
+
+    // Invalidates everything allocated since the last reset; block memory
+    // is kept for reuse.
+    void reset()
+    {
+        cur_block = 0;
+        offset = 0;
+        overflow.clear();
+    }
+
+    static Arena &threadLocal()
+    {
+        static thread_local Arena arena;
+        return arena;
+    }
+
+private:
+    std::vector<std::unique_ptr<char[]>> blocks;
+    size_t cur_block = 0; // block currently being bumped
+    size_t offset = 0;    // bump offset within it
+    std::vector<std::unique_ptr<char[]>> overflow;
+};
+
+/* ------------------------------------------------------------
+   Standard-allocator adapter so std containers can live in the
+   arena. Default-constructs against the calling thread's arena;
+   deallocate is a no-op (reset() frees wholesale).
+   ------------------------------------------------------------ */
+template <typename T>
+struct ArenaAllocator
+{
+    using value_type = T;
+
+    Arena *arena;
+
+    ArenaAllocator() : arena(&Arena::threadLocal()) {}
+    explicit ArenaAllocator(Arena &a) : arena(&a) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other) : arena(other.arena) {}
+
+    T *allocate(size_t n)
+    {
+        return static_cast<T *>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+
+    void deallocate(T *, size_t) {} // freed wholesale by Arena::reset()
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U> &other) const
+    {
+        return arena == other.arena;
+    }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U> &other) const
+    {
+        return arena != other.arena;
+    }
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+#endif // ARENA_H
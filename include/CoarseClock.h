@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+/* ------------------------------------------------------------
+   Process-wide coarse clock.
+
+   Every read checks expiry and every log line takes a timestamp;
+   at high throughput the clock call itself (one vDSO call per
+   operation) shows up in profiles. A background ticker refreshes
+   a cached time once every TICK_MS milliseconds, and readers pay
+   a single relaxed atomic load instead. Resolution is ~TICK_MS
+   (a key may expire that much late), which is well inside the
+   precision anything here needs.
+
+   Both clocks are cached: system_clock for expiry deadlines and
+   log timestamps, steady_clock (as ms since process start) for
+   recency stamps. First use starts the ticker.
+   ------------------------------------------------------------ */
+class CoarseClock
+{
+public:
+    static constexpr int64_t TICK_MS = 5;
+
+    // Cached wall-clock time (system_clock, ~TICK_MS resolution)
+    static std::chrono::system_clock::time_point now()
+    {
+        return std::chrono::system_clock::time_point(
+            std::chrono::milliseconds(
+                instance().wall_ms.load(std::memory_order_relaxed)));
+    }
+
+    // Cached monotonic milliseconds since process start
+    static int64_t steadyMs()
+    {
+        return instance().mono_ms.load(std::memory_order_relaxed);
+    }
+
+private:
+    CoarseClock()
+    {
+        refresh();
+        ticker = std::thread([this]()
+                             {
+            while (!stopping.load(std::memory_order_acquire))
+            {
+                refresh();
+                std::this_thread::sleep_for(std::chrono::milliseconds(TICK_MS));
+            } });
+    }
+
+    ~CoarseClock()
+    {
+        stopping.store(true, std::memory_order_release);
+        if (ticker.joinable())
+            ticker.join();
+    }
+
+    CoarseClock(const CoarseClock &) = delete;
+    CoarseClock &operator=(const CoarseClock &) = delete;
+
+    static CoarseClock &instance()
+    {
+        static CoarseClock inst;
+        return inst;
+    }
+
+    void refresh()
+    {
+        static const auto start = std::chrono::steady_clock::now();
+
+        wall_ms.store(std::chrono::duration_cast<std::chrono::milliseconds>(
+                          std::chrono::system_clock::now().time_since_epoch())
+                          .count(),
+                      std::memory_order_relaxed);
+        mono_ms.store(std::chrono::duration_cast<std::chrono::milliseconds>(
+                          std::chrono::steady_clock::now() - start)
+                          .count(),
+                      std::memory_order_relaxed);
+    }
+
+    std::atomic<int64_t> wall_ms{0};
+    std::atomic<int64_t> mono_ms{0};
+    std::atomic<bool> stopping{false};
+    std::thread ticker;
+};
@@ -0,0 +1,684 @@
+#ifndef COMPACT_VALUE_H
+#define COMPACT_VALUE_H
+
+#include <string>
+#include <string_view>
+#include <deque>
+#include <unordered_map>
+#include <cstring>
+#include <cstdint>
+
+/* ============================================================
+   Transparent hash/equal so the stores accept std::string_view
+   lookups without materializing a std::string (heterogeneous
+   lookup, C++20). Keys are still owned as std::string; a string
+   is only constructed on actual insert.
+   ============================================================ */
+struct SvHash
+{
+   using is_transparent = void;
+   size_t operator()(std::string_view v) const noexcept
+   {
+      return std::hash<std::string_view>{}(v);
+   }
+};
+
+struct SvEqual
+{
+   using is_transparent = void;
+   bool operator()(std::string_view a, std::string_view b) const noexcept
+   {
+      return a == b;
+   }
+};
+
+template <typename V>
+using StringMap = std::unordered_map<std::string, V, SvHash, SvEqual>;
+
+/* ============================================================
+   Compact (listpack-style) encodings for small hashes and lists.
+
+   A small object lives in ONE contiguous std::string of
+   length-prefixed entries (u32 len | bytes) — a single heap
+   block instead of hash buckets / deque chunk maps plus a heap
+   allocation per string. Millions of 3-10 field session hashes
+   are exactly this shape, and the per-object overhead of the
+   full containers roughly triples RSS versus payload.
+
+   Each wrapper transparently upgrades to the ordinary
+   map/deque representation the first time it outgrows the
+   thresholds (field count, single-entry size, or total bytes);
+   it never downgrades. All database APIs go through these
+   wrappers, so callers see no difference.
+   ============================================================ */
+
+namespace compact_detail
+{
+    constexpr size_t FLAT_MAX_ENTRIES = 16;  // fields (hash) / items (list)
+    constexpr size_t FLAT_MAX_ENTRY = 128;   // bytes per field, value or item
+    constexpr size_t FLAT_MAX_BYTES = 4096;  // total encoded buffer size
+
+    // Approximate heap cost of one entry in the upgraded representation
+    // (map node / deque slot plus a small std::string) — used by the
+    // memUsage() accounting that feeds maxmemory eviction.
+    constexpr size_t UPGRADED_ENTRY_OVERHEAD = 64;
+
+    inline void appendEntry(std::string &buf, std::string_view v)
+    {
+        uint32_t n = (uint32_t)v.size();
+        buf.append((const char *)&n, 4);
+        buf.append(v.data(), v.size());
+    }
+
+    // Reads the entry at off and advances off past it
+    inline std::string_view entryAt(const std::string &buf, size_t &off)
+    {
+        uint32_t n;
+        std::memcpy(&n, buf.data() + off, 4);
+        std::string_view v(buf.data() + off + 4, n);
+        off += 4 + (size_t)n;
+        return v;
+    }
+}
+
+/* ------------------------------------------------------------
+   KvValue — typed string-store value.
+
+   Values that are canonical decimal int64 ("42", "-7", but not
+   "042" or " 7", which must round-trip byte-for-byte) are kept
+   as a raw integer: INCR becomes an in-place add with no parse
+   or reformat, and small-integer SETs never touch the heap.
+   Everything else is stored as the string it arrived as; GET
+   formats integers on demand.
+   ------------------------------------------------------------ */
+class KvValue
+{
+public:
+    KvValue() = default;
+    explicit KvValue(std::string_view v) { assign(v); }
+
+    void assign(std::string_view v)
+    {
+        long long n;
+        if (parseInt(v, n))
+        {
+            is_int = true;
+            ival = n;
+            str.clear();
+            str.shrink_to_fit();
+        }
+        else
+        {
+            is_int = false;
+            str.assign(v.data(), v.size());
+        }
+    }
+
+    std::string toString() const
+    {
+        return is_int ? std::to_string(ival) : str;
+    }
+
+    // Approximate heap bytes held by this value (integers live inline)
+    size_t memUsage() const
+    {
+        return is_int ? 0 : str.capacity();
+    }
+
+    // INCR: in-place add on the integer representation; a string value is
+    // parsed once (whitespace-trimmed, matching the old behavior) and
+    // converted. Returns false on non-integer values and on overflow.
+    bool tryIncr(long long &out)
+    {
+        if (!is_int)
+        {
+            size_t b = str.find_first_not_of(" \t\r\n");
+            if (b == std::string::npos)
+                return false;
+            size_t e = str.find_last_not_of(" \t\r\n");
+
+            long long n;
+            if (!parseInt(std::string_view(str).substr(b, e - b + 1), n))
+                return false;
+
+            is_int = true;
+            ival = n;
+            str.clear();
+            str.shrink_to_fit();
+        }
+
+        if (ival == INT64_MAX)
+            return false;
+
+        out = ++ival;
+        return true;
+    }
+
+private:
+    // Strict canonical parse so toString() reproduces the input exactly
+    static bool parseInt(std::string_view v, long long &out)
+    {
+        if (v.empty() || v.size() > 20)
+            return false;
+
+        size_t i = 0;
+        bool neg = false;
+        if (v[0] == '-')
+        {
+            neg = true;
+            i = 1;
+            if (v.size() == 1 || v[1] == '0')
+                return false; // "-" / "-0" / "-0..." stay strings
+        }
+        if (v[i] == '0' && v.size() > i + 1)
+            return false; // leading zeros stay strings
+
+        unsigned long long acc = 0;
+        const unsigned long long limit =
+            neg ? 9223372036854775808ULL : 9223372036854775807ULL;
+
+        for (; i < v.size(); i++)
+        {
+            if (v[i] < '0' || v[i] > '9')
+                return false;
+            acc = acc * 10 + (unsigned long long)(v[i] - '0');
+            if (acc > limit)
+                return false;
+        }
+
+        out = neg ? (long long)(0ULL - acc) : (long long)acc;
+        return true;
+    }
+
+    bool is_int = false;
+    long long ival = 0;
+    std::string str;
+};
+
+/* ------------------------------------------------------------
+   CompactHash — flat buffer of (field, value) entry pairs
+   ------------------------------------------------------------ */
+class CompactHash
+{
+public:
+    size_t size() const { return flat ? count : map.size(); }
+    bool empty() const { return size() == 0; }
+
+    // Approximate heap bytes: the flat buffer itself, or the upgraded
+    // map's payload plus a fixed per-pair node estimate. O(1) — payload
+    // bytes are tracked incrementally on every mutation.
+    size_t memUsage() const
+    {
+        if (flat)
+            return buf.capacity();
+        return mem + compact_detail::UPGRADED_ENTRY_OVERHEAD * map.size();
+    }
+
+    bool contains(std::string_view field) const
+    {
+        if (!flat)
+            return map.find(field) != map.end();
+        return findPair(field) != npos;
+    }
+
+    bool get(std::string_view field, std::string &out) const
+    {
+        if (!flat)
+        {
+            auto it = map.find(field);
+            if (it == map.end())
+                return false;
+            out = it->second;
+            return true;
+        }
+
+        size_t off = findPair(field);
+        if (off == npos)
+            return false;
+
+        compact_detail::entryAt(buf, off); // skip field
+        out = std::string(compact_detail::entryAt(buf, off));
+        return true;
+    }
+
+    // Returns true if the field was newly created
+    bool set(std::string_view field, std::string_view value)
+    {
+        using namespace compact_detail;
+
+        if (flat && (field.size() > FLAT_MAX_ENTRY || value.size() > FLAT_MAX_ENTRY))
+            upgrade();
+
+        if (!flat)
+        {
+            auto it = map.find(field);
+            if (it != map.end())
+            {
+                mem += value.size();
+                mem -= it->second.size();
+                it->second.assign(value.data(), value.size());
+                return false;
+            }
+            map.emplace(std::string(field), std::string(value));
+            mem += field.size() + value.size();
+            return true;
+        }
+
+        size_t off = findPair(field);
+        bool created = (off == npos);
+
+        if (!created)
+        {
+            // replace in place: drop the old pair, re-append the new one
+            size_t end = off;
+            entryAt(buf, end);
+            entryAt(buf, end);
+            buf.erase(off, end - off);
+            count--;
+        }
+
+        appendEntry(buf, field);
+        appendEntry(buf, value);
+        count++;
+
+        if (count > FLAT_MAX_ENTRIES || buf.size() > FLAT_MAX_BYTES)
+            upgrade();
+
+        return created;
+    }
+
+    bool erase(std::string_view field)
+    {
+        if (!flat)
+        {
+            auto it = map.find(field);
+            if (it == map.end())
+                return false;
+            mem -= it->first.size() + it->second.size();
+            map.erase(it);
+            return true;
+        }
+
+        size_t off = findPair(field);
+        if (off == npos)
+            return false;
+
+        size_t end = off;
+        compact_detail::entryAt(buf, end);
+        compact_detail::entryAt(buf, end);
+        buf.erase(off, end - off);
+        count--;
+        return true;
+    }
+
+    // f(field, value) over every pair, in storage order
+    template <typename F>
+    void forEach(F &&f) const
+    {
+        if (!flat)
+        {
+            for (auto &p : map)
+                f(std::string_view(p.first), std::string_view(p.second));
+            return;
+        }
+
+        size_t off = 0;
+        while (off < buf.size())
+        {
+            std::string_view fld = compact_detail::entryAt(buf, off);
+            std::string_view val = compact_detail::entryAt(buf, off);
+            f(fld, val);
+        }
+    }
+
+    // Incremental walk for HSCAN: visit(field, value) returns whether the
+    // pair was accepted. While flat the whole object is emitted in one call
+    // (it holds at most FLAT_MAX_ENTRIES pairs); once upgraded this walks
+    // the map's buckets and pauses at a bucket boundary after ~count
+    // accepted pairs. Returns the next bucket cursor, 0 when done.
+    template <typename F>
+    uint64_t scanStep(uint64_t cursor, size_t count, F &&visit) const
+    {
+        if (flat)
+        {
+            forEach([&](std::string_view fld, std::string_view val)
+                    { visit(fld, val); });
+            return 0;
+        }
+
+        size_t bucket = (size_t)cursor;
+        size_t nb = map.bucket_count();
+        size_t accepted = 0;
+
+        while (bucket < nb)
+        {
+            for (auto it = map.begin(bucket); it != map.end(bucket); ++it)
+            {
+                if (visit(std::string_view(it->first), std::string_view(it->second)))
+                    accepted++;
+            }
+            bucket++;
+
+            if (accepted >= count && bucket < nb)
+                return (uint64_t)bucket;
+        }
+        return 0;
+    }
+
+private:
+    static constexpr size_t npos = (size_t)-1;
+
+    // Offset of the pair whose field matches, or npos
+    size_t findPair(std::string_view field) const
+    {
+        size_t off = 0;
+        while (off < buf.size())
+        {
+            size_t start = off;
+            std::string_view fld = compact_detail::entryAt(buf, off);
+            compact_detail::entryAt(buf, off); // value
+            if (fld == field)
+                return start;
+        }
+        return npos;
+    }
+
+    void upgrade()
+    {
+        if (!flat)
+            return;
+
+        map.reserve(count + 1);
+        size_t off = 0;
+        while (off < buf.size())
+        {
+            std::string_view fld = compact_detail::entryAt(buf, off);
+            std::string_view val = compact_detail::entryAt(buf, off);
+            map.emplace(std::string(fld), std::string(val));
+            mem += fld.size() + val.size();
+        }
+
+        buf.clear();
+        buf.shrink_to_fit();
+        count = 0;
+        flat = false;
+    }
+
+    bool flat = true;
+    size_t count = 0;           // pairs while flat
+    size_t mem = 0;             // payload bytes while upgraded
+    std::string buf;            // flat encoding
+    StringMap<std::string> map; // upgraded representation
+};
+
+/* ------------------------------------------------------------
+   CompactList — flat buffer of item entries in list order
+   ------------------------------------------------------------ */
+class CompactList
+{
+public:
+    size_t size() const { return flat ? count : dq.size(); }
+    bool empty() const { return size() == 0; }
+
+    // Approximate heap bytes (same scheme as CompactHash::memUsage)
+    size_t memUsage() const
+    {
+        if (flat)
+            return buf.capacity();
+        return mem + compact_detail::UPGRADED_ENTRY_OVERHEAD * dq.size();
+    }
+
+    void push_front(std::string_view v)
+    {
+        maybeUpgradeFor(v);
+        if (!flat)
+        {
+            mem += v.size();
+            dq.emplace_front(v);
+            return;
+        }
+
+        std::string entry;
+        compact_detail::appendEntry(entry, v);
+        buf.insert(0, entry);
+        count++;
+        maybeUpgradeGrown();
+    }
+
+    void push_back(std::string_view v)
+    {
+        maybeUpgradeFor(v);
+        if (!flat)
+        {
+            mem += v.size();
+            dq.emplace_back(v);
+            return;
+        }
+
+        compact_detail::appendEntry(buf, v);
+        count++;
+        maybeUpgradeGrown();
+    }
+
+    bool pop_front(std::string &out)
+    {
+        if (!flat)
+        {
+            if (dq.empty())
+                return false;
+            mem -= dq.front().size();
+            out = std::move(dq.front());
+            dq.pop_front();
+            return true;
+        }
+
+        if (count == 0)
+            return false;
+
+        size_t off = 0;
+        out = std::string(compact_detail::entryAt(buf, off));
+        buf.erase(0, off);
+        count--;
+        return true;
+    }
+
+    bool pop_back(std::string &out)
+    {
+        if (!flat)
+        {
+            if (dq.empty())
+                return false;
+            mem -= dq.back().size();
+            out = std::move(dq.back());
+            dq.pop_back();
+            return true;
+        }
+
+        if (count == 0)
+            return false;
+
+        size_t start = offsetOf(count - 1);
+        size_t off = start;
+        out = std::string(compact_detail::entryAt(buf, off));
+        buf.erase(start);
+        count--;
+        return true;
+    }
+
+    bool index(size_t i, std::string &out) const
+    {
+        if (!flat)
+        {
+            if (i >= dq.size())
+                return false;
+            out = dq[i];
+            return true;
+        }
+
+        if (i >= count)
+            return false;
+
+        size_t off = offsetOf(i);
+        out = std::string(compact_detail::entryAt(buf, off));
+        return true;
+    }
+
+    bool assign(size_t i, std::string_view v)
+    {
+        if (!flat)
+        {
+            if (i >= dq.size())
+                return false;
+            mem += v.size();
+            mem -= dq[i].size();
+            dq[i].assign(v.data(), v.size());
+            return true;
+        }
+
+        if (i >= count)
+            return false;
+
+        if (v.size() > compact_detail::FLAT_MAX_ENTRY)
+        {
+            upgrade();
+            mem += v.size();
+            mem -= dq[i].size();
+            dq[i].assign(v.data(), v.size());
+            return true;
+        }
+
+        size_t start = offsetOf(i);
+        size_t end = start;
+        compact_detail::entryAt(buf, end);
+
+        std::string entry;
+        compact_detail::appendEntry(entry, v);
+        buf.replace(start, end - start, entry);
+        return true;
+    }
+
+    // f(item) front to back
+    template <typename F>
+    void forEach(F &&f) const
+    {
+        if (!flat)
+        {
+            for (auto &v : dq)
+                f(std::string_view(v));
+            return;
+        }
+
+        size_t off = 0;
+        while (off < buf.size())
+            f(compact_detail::entryAt(buf, off));
+    }
+
+    // f(item) over indices [start, stop] only (both inclusive, assumed
+    // normalized and in range) — an LRANGE window never touches the rest
+    template <typename F>
+    void forRange(size_t start, size_t stop, F &&f) const
+    {
+        if (!flat)
+        {
+            for (size_t i = start; i <= stop && i < dq.size(); i++)
+                f(std::string_view(dq[i]));
+            return;
+        }
+
+        size_t off = offsetOf(start);
+        for (size_t i = start; i <= stop && i < count; i++)
+            f(compact_detail::entryAt(buf, off));
+    }
+
+    // Wholesale replacement (LREM rebuild); picks the representation
+    // that fits the new contents.
+    void assignFrom(std::deque<std::string> &&items)
+    {
+        using namespace compact_detail;
+
+        bool fits = items.size() <= FLAT_MAX_ENTRIES;
+        size_t total = 0;
+        if (fits)
+        {
+            for (auto &v : items)
+            {
+                if (v.size() > FLAT_MAX_ENTRY)
+                {
+                    fits = false;
+                    break;
+                }
+                total += 4 + v.size();
+            }
+        }
+
+        buf.clear();
+        dq.clear();
+        mem = 0;
+
+        if (fits && total <= FLAT_MAX_BYTES)
+        {
+            flat = true;
+            count = items.size();
+            buf.reserve(total);
+            for (auto &v : items)
+                appendEntry(buf, v);
+        }
+        else
+        {
+            flat = false;
+            count = 0;
+            dq = std::move(items);
+            for (auto &v : dq)
+                mem += v.size();
+        }
+    }
+
+private:
+    size_t offsetOf(size_t i) const
+    {
+        size_t off = 0;
+        while (i-- > 0)
+            compact_detail::entryAt(buf, off);
+        return off;
+    }
+
+    void maybeUpgradeFor(std::string_view v)
+    {
+        if (flat && v.size() > compact_detail::FLAT_MAX_ENTRY)
+            upgrade();
+    }
+
+    void maybeUpgradeGrown()
+    {
+        if (flat && (count > compact_detail::FLAT_MAX_ENTRIES ||
+                     buf.size() > compact_detail::FLAT_MAX_BYTES))
+            upgrade();
+    }
+
+    void upgrade()
+    {
+        if (!flat)
+            return;
+
+        size_t off = 0;
+        while (off < buf.size())
+        {
+            std::string_view v = compact_detail::entryAt(buf, off);
+            dq.emplace_back(v);
+            mem += v.size();
+        }
+
+        buf.clear();
+        buf.shrink_to_fit();
+        count = 0;
+        flat = false;
+    }
+
+    bool flat = true;
+    size_t count = 0;            // items while flat
+    size_t mem = 0;              // payload bytes while upgraded
+    std::string buf;             // flat encoding
+    std::deque<std::string> dq;  // upgraded representation
+};
+
+#endif // COMPACT_VALUE_H
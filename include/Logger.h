@@ -13,14 +13,16 @@
 #include <condition_variable>
 #include <fstream>
 #include <iomanip>
+#include <memory>
 #include <mutex>
-#include <queue>
 #include <sstream>
 #include <string>
 #include <thread>
 #include <vector>
 #include <filesystem>
 
+#include "CoarseClock.h"
+
 class Logger
 {
 public:
@@ -49,6 +51,13 @@ public:
         return static_cast<Level>(level.load(std::memory_order_relaxed));
     }
 
+    // Cheap pre-check so callers (via the LOG_* macros below) can skip
+    // building the message string entirely when the level is filtered.
+    bool enabled(Level lvl) const
+    {
+        return static_cast<int>(lvl) >= level.load(std::memory_order_relaxed);
+    }
+
     void debug(const std::string &msg) { log(Level::DEBUG, "", msg); }
     void info(const std::string &msg) { log(Level::INFO, "", msg); }
     void warn(const std::string &msg) { log(Level::WARN, "", msg); }
@@ -63,11 +72,6 @@ public:
         if (!stopping.compare_exchange_strong(expected, true))
             return;
 
-        {
-            std::lock_guard<std::mutex> lk(queueMutex);
-            queueCond.notify_one();
-        }
-
         if (worker.joinable())
             worker.join();
     }
@@ -84,12 +88,29 @@ private:
 
     static constexpr size_t MAX_BATCH = 256;
     static constexpr std::chrono::milliseconds FLUSH_INTERVAL{200};
-    static constexpr size_t MAX_QUEUE = 64 * 1024;
+
+    /* ------------------------------------------------------------
+       Bounded lock-free MPSC ring (Vyukov-style sequenced slots).
+       Producers claim a slot with one CAS and never take a mutex;
+       when the ring is full the message is dropped and counted
+       rather than ever blocking the caller under burst load. The
+       single consumer is the worker thread.
+       ------------------------------------------------------------ */
+    static constexpr size_t RING_SIZE = 16 * 1024; // power of two
+    static constexpr size_t RING_MASK = RING_SIZE - 1;
+
+    struct Slot
+    {
+        std::atomic<size_t> seq{0};
+        Item item;
+    };
+
+    std::unique_ptr<Slot[]> ring = std::make_unique<Slot[]>(RING_SIZE);
+    std::atomic<size_t> enqueue_pos{0};
+    size_t dequeue_pos{0}; // consumer-private
+    std::atomic<uint64_t> dropped{0};
 
     std::atomic<int> level{static_cast<int>(Level::INFO)};
-    std::mutex queueMutex;
-    std::condition_variable queueCond;
-    std::deque<Item> queue;
 
     std::thread worker;
     std::atomic<bool> stopping{false};
@@ -101,6 +122,10 @@ private:
     Logger()
     {
         std::filesystem::create_directory("logs");
+
+        for (size_t i = 0; i < RING_SIZE; i++)
+            ring[i].seq.store(i, std::memory_order_relaxed);
+
         worker = std::thread([this]()
                              { workerLoop(); });
     }
@@ -115,23 +140,69 @@ private:
 
     void log(Level lvl, const std::string &client, const std::string &msg, const std::string &tag = "")
     {
-        if (static_cast<int>(lvl) < level.load(std::memory_order_relaxed))
+        if (!enabled(lvl))
             return;
 
         Item it;
-        it.tp = std::chrono::system_clock::now();
+        it.tp = CoarseClock::now(); // ~5ms resolution is plenty for a log line
         it.level = lvl;
         it.client = client;
         it.tag = tag;
         it.msg = msg;
 
-        std::unique_lock<std::mutex> lk(queueMutex);
-        if (queue.size() >= MAX_QUEUE)
-            queue.pop_front();
+        if (!tryPush(std::move(it)))
+            dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Multi-producer enqueue: claim a slot whose sequence matches the
+    // enqueue position, fill it, then publish by bumping the sequence.
+    // A negative difference means the consumer hasn't freed the slot yet
+    // — ring full — and we return false instead of spinning or blocking.
+    bool tryPush(Item &&it)
+    {
+        size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+
+        for (;;)
+        {
+            Slot &slot = ring[pos & RING_MASK];
+            size_t seq = slot.seq.load(std::memory_order_acquire);
+            intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+
+            if (dif == 0)
+            {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                                                      std::memory_order_relaxed))
+                {
+                    slot.item = std::move(it);
+                    slot.seq.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+                // lost the race: pos was reloaded by compare_exchange
+            }
+            else if (dif < 0)
+            {
+                return false; // full
+            }
+            else
+            {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Single-consumer dequeue (worker thread only)
+    bool tryPop(Item &out)
+    {
+        Slot &slot = ring[dequeue_pos & RING_MASK];
+        size_t seq = slot.seq.load(std::memory_order_acquire);
+
+        if ((intptr_t)seq - (intptr_t)(dequeue_pos + 1) < 0)
+            return false; // empty
 
-        queue.emplace_back(std::move(it));
-        lk.unlock();
-        queueCond.notify_one();
+        out = std::move(slot.item);
+        slot.seq.store(dequeue_pos + RING_SIZE, std::memory_order_release);
+        dequeue_pos++;
+        return true;
     }
 
     void workerLoop()
@@ -139,43 +210,47 @@ private:
         std::vector<Item> batch;
         batch.reserve(MAX_BATCH);
 
-        while (!stopping.load())
+        auto drain = [&]()
         {
+            Item it;
+            while (tryPop(it))
             {
-                std::unique_lock<std::mutex> lk(queueMutex);
-                if (queue.empty())
-                    queueCond.wait_for(lk, FLUSH_INTERVAL);
-
-                while (!queue.empty() && batch.size() < MAX_BATCH)
+                batch.emplace_back(std::move(it));
+                if (batch.size() >= MAX_BATCH)
                 {
-                    batch.emplace_back(std::move(queue.front()));
-                    queue.pop_front();
+                    writeBatch(batch);
+                    batch.clear();
                 }
             }
-
             if (!batch.empty())
             {
                 writeBatch(batch);
                 batch.clear();
             }
-        }
+        };
 
+        while (!stopping.load())
         {
-            std::unique_lock<std::mutex> lk(queueMutex);
-            while (!queue.empty())
+            drain();
+
+            uint64_t d = dropped.exchange(0, std::memory_order_relaxed);
+            if (d > 0)
             {
-                batch.emplace_back(std::move(queue.front()));
-                queue.pop_front();
-                if (batch.size() >= MAX_BATCH)
-                {
-                    writeBatch(batch);
-                    batch.clear();
-                }
+                Item it;
+                it.tp = CoarseClock::now();
+                it.level = Level::WARN;
+                it.msg = "logger ring full: dropped " + std::to_string(d) + " messages";
+                batch.emplace_back(std::move(it));
+                writeBatch(batch);
+                batch.clear();
             }
+
+            // Producers never signal (they are lock-free); poll on a
+            // flush cadence instead.
+            std::this_thread::sleep_for(FLUSH_INTERVAL);
         }
 
-        if (!batch.empty())
-            writeBatch(batch);
+        drain();
     }
 
     void writeBatch(const std::vector<Item> &batch)
@@ -270,3 +345,38 @@ private:
         outFile.open(ss.str(), std::ios::app);
     }
 };
+
+/* ------------------------------------------------------------
+   Level-gated logging macros: the level check runs BEFORE the
+   message expression is evaluated, so a filtered-out LOG_DEBUG
+   never pays for string concatenation or std::to_string on the
+   hot path. Prefer these over the direct methods anywhere the
+   message is built from pieces.
+   ------------------------------------------------------------ */
+#define LOG_DEBUG(expr)                                                  \
+    do                                                                   \
+    {                                                                    \
+        if (Logger::getInstance().enabled(Logger::Level::DEBUG))         \
+            Logger::getInstance().debug(expr);                           \
+    } while (0)
+
+#define LOG_INFO(expr)                                                   \
+    do                                                                   \
+    {                                                                    \
+        if (Logger::getInstance().enabled(Logger::Level::INFO))          \
+            Logger::getInstance().info(expr);                            \
+    } while (0)
+
+#define LOG_WARN(expr)                                                   \
+    do                                                                   \
+    {                                                                    \
+        if (Logger::getInstance().enabled(Logger::Level::WARN))          \
+            Logger::getInstance().warn(expr);                            \
+    } while (0)
+
+#define LOG_ERROR(expr)                                                  \
+    do                                                                   \
+    {                                                                    \
+        if (Logger::getInstance().enabled(Logger::Level::ERROR))         \
+            Logger::getInstance().error(expr);                           \
+    } while (0)
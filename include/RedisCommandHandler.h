@@ -5,11 +5,20 @@
 #include <string_view>
 #include <vector>
 
+#include "Arena.h"
+
 class RedisCommandHandler
 {
 public:
     RedisCommandHandler();
 
+    // Frame list handed back by splitFrames: zero-copy views into the
+    // connection buffer, with the vector itself carved from the calling
+    // thread's arena. Both are batch-scoped — valid until the next
+    // splitFrames call on this thread (which resets the arena and may
+    // compact the buffer) or until the buffer is otherwise modified.
+    using RespFrames = ArenaVector<std::string_view>;
+
     // Zero-copy command handler using string_view
     std::string processCommand(std::string_view commandView);
 
@@ -18,15 +27,36 @@ public:
 
     // IMPORTANT:
     // This version CONSUMES bytes from buffer (by reference),
-    // removes complete RESP frames, and returns them.
-    std::vector<std::string> splitFrames(std::string &buffer);
+    // removes complete RESP frames, and returns views of them.
+    //
+    // The parse is incremental: the handler remembers how far it got into
+    // a partial frame (remaining element count, remaining bulk bytes), so
+    // each call only examines bytes that arrived since the last one —
+    // streaming a large bulk value costs O(new bytes), not a re-scan of
+    // everything buffered. Consumed bytes are tracked as an offset and the
+    // buffer is only compacted at the start of the NEXT call (so the
+    // returned views stay valid while the batch is processed), and only
+    // when the dead prefix has grown large.
+    RespFrames splitFrames(std::string &buffer);
 
 private:
-    // RESP parser that returns zero-copy views
-    std::vector<std::string_view> parseRespViews(std::string_view input);
+    // RESP parser that returns zero-copy views (arena-backed)
+    ArenaVector<std::string_view> parseRespViews(std::string_view input);
 
     // Convert views to real strings for DB operations
-    std::vector<std::string> materialize(const std::vector<std::string_view> &views);
+    std::vector<std::string> materialize(const ArenaVector<std::string_view> &views);
+
+    /* ---------------- incremental frame-splitter state ----------------
+       consumed_  bytes before this offset were already emitted as frames
+       scan_      validated up to here inside the frame being parsed
+       elems_left_  bulk strings still expected in the current array
+                    frame (-1 = between frames)
+       bulk_left_   payload+CRLF bytes still owed by the current bulk
+                    string (-1 = expecting a $<len> header next)        */
+    size_t consumed_ = 0;
+    size_t scan_ = 0;
+    int elems_left_ = -1;
+    long long bulk_left_ = -1;
 };
 
 #endif
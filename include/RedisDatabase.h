@@ -2,14 +2,31 @@
 #define REDIS_DATABASE_H
 
 #include <string>
+#include <string_view>
+#include <optional>
 #include <vector>
+#include <array>
 #include <deque>
 #include <unordered_map>
 #include <chrono>
+#include <memory>
 #include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <functional>
+#include <queue>
 #include <sys/types.h> // ssize_t on POSIX; on Windows you may need to typedef ssize_t
 
-// Simple, thread-safe Redis-like in-memory DB. Single-shard for clarity.
+// StringMap (transparent string_view lookup) plus the CompactHash /
+// CompactList value wrappers that flat-encode small objects
+#include "CompactValue.h"
+
+// Thread-safe Redis-like in-memory DB.
+// Keys are routed by hash onto SHARD_COUNT independent shards, each owning its
+// own maps, expiry state and mutex, so operations on different keys never
+// contend on the same lock.
 class RedisDatabase
 {
 public:
@@ -22,65 +39,191 @@ public:
    bool flushAll();
 
    // Key-Value
-   void set(const std::string &key, const std::string &value);
-   bool get(const std::string &key, std::string &value);
+   void set(std::string_view key, std::string_view value);
+   bool get(std::string_view key, std::string &value);
+   // Batch Key-Value: lock each involved shard once and do every
+   // lookup/store for that shard inside the single critical section.
+   // Missing (or expired) keys come back as nullopt.
+   void mget(const std::vector<std::string_view> &keys,
+             std::vector<std::optional<std::string>> &out);
+   void mset(const std::vector<std::pair<std::string_view, std::string_view>> &kvs);
+
    std::vector<std::string> keys();
-   std::string type(const std::string &key);
-   bool del(const std::string &key);
 
-   bool expire(const std::string &key, int seconds);
-   int ttl(const std::string &key); // (-1 no TTL, -2 missing)
+   /* ============================================================
+      CURSOR ITERATION (SCAN / HSCAN)
+
+      Incremental keyspace walk: each call visits at most ~count
+      entries under one shard lock and hands back an opaque cursor
+      (0 = iteration finished). The cursor encodes store / shard /
+      bucket indices; a concurrent rehash can make a walk miss or
+      repeat keys (same caveat as Redis SCAN) but never loop or
+      crash — out-of-range bucket indices simply skip ahead.
+      pattern: glob (* and ?); empty matches everything.
+      ============================================================ */
+   uint64_t scan(uint64_t cursor, size_t count, std::string_view pattern,
+                 std::vector<std::string> &out);
+   uint64_t hscan(std::string_view key, uint64_t cursor, size_t count,
+                  std::string_view pattern,
+                  std::vector<std::pair<std::string, std::string>> &out);
+
+   std::string type(std::string_view key);
+   bool del(std::string_view key);
+
+   bool expire(std::string_view key, int seconds);
+   int ttl(std::string_view key); // (-1 no TTL, -2 missing)
 
    void purgeExpired();
-   bool rename(const std::string &oldKey, const std::string &newKey);
+   bool rename(std::string_view oldKey, std::string_view newKey);
+
+   // Per-type key counts across all shards (INFO keyspace section)
+   void storeSizes(size_t &kv, size_t &lists, size_t &hashes);
 
    /* ============================================================
       NUMERIC OPERATIONS
       ============================================================ */
    // Strict increment - throws on error (convenience)
-   long long incr(const std::string &key);
+   long long incr(std::string_view key);
 
    // Safe INCR: returns false if value is non-integer; out contains new value when true
-   bool incr(const std::string &key, long long &out);
+   bool incr(std::string_view key, long long &out);
 
    /* ============================================================
       LIST OPERATIONS
       ============================================================ */
-   std::vector<std::string> lget(const std::string &key);
-   ssize_t llen(const std::string &key);
-   void lpush(const std::string &key, const std::string &value);
-   void rpush(const std::string &key, const std::string &value);
-   bool lpop(const std::string &key, std::string &value);
-   bool rpop(const std::string &key, std::string &value);
-   int lrem(const std::string &key, int count, const std::string &value);
-   bool lindex(const std::string &key, int index, std::string &value);
-   bool lset(const std::string &key, int index, const std::string &value);
+   std::vector<std::string> lget(std::string_view key);
+
+   // Ranged read (LRANGE): copies only the [start, stop] window out under
+   // the lock — negative indices count from the tail, Redis-style. lget's
+   // whole-list copy is kept for callers that really need everything
+   // (AOF rewrite).
+   void lrange(std::string_view key, int start, int stop,
+               std::vector<std::string> &out);
+
+   ssize_t llen(std::string_view key);
+   void lpush(std::string_view key, std::string_view value);
+   void rpush(std::string_view key, std::string_view value);
+   bool lpop(std::string_view key, std::string &value);
+   bool rpop(std::string_view key, std::string &value);
+   int lrem(std::string_view key, int count, std::string_view value);
+   bool lindex(std::string_view key, int index, std::string &value);
+   bool lset(std::string_view key, int index, std::string_view value);
 
    /* ============================================================
       HASH OPERATIONS
       ============================================================ */
-   bool hset(const std::string &key, const std::string &field, const std::string &value);
-   bool hget(const std::string &key, const std::string &field, std::string &value);
-   bool hexists(const std::string &key, const std::string &field);
-   bool hdel(const std::string &key, const std::string &field);
+   bool hset(std::string_view key, std::string_view field, std::string_view value);
+   bool hget(std::string_view key, std::string_view field, std::string &value);
+   bool hexists(std::string_view key, std::string_view field);
+   bool hdel(std::string_view key, std::string_view field);
+
+   // Batch field fetch under one shard lock (HMGET)
+   void hmget(std::string_view key,
+              const std::vector<std::string_view> &fields,
+              std::vector<std::optional<std::string>> &out);
 
-   std::unordered_map<std::string, std::string> hgetall(const std::string &key);
-   std::vector<std::string> hkeys(const std::string &key);
-   std::vector<std::string> hvals(const std::string &key);
-   ssize_t hlen(const std::string &key);
+   std::unordered_map<std::string, std::string> hgetall(std::string_view key);
 
-   bool hmset(const std::string &key,
+   // Visitor form: visit(field, value) runs for every pair under the shard
+   // lock (shared), so HGETALL serializes straight from the stored hash
+   // with no intermediate map copy. The callback must not call back into
+   // the database.
+   void hgetall(std::string_view key,
+                const std::function<void(std::string_view, std::string_view)> &visit);
+   std::vector<std::string> hkeys(std::string_view key);
+   std::vector<std::string> hvals(std::string_view key);
+   ssize_t hlen(std::string_view key);
+
+   bool hmset(std::string_view key,
               const std::vector<std::pair<std::string, std::string>> &fieldValues);
 
    /* ============================================================
       PERSISTENCE
       ============================================================ */
+   // dump() writes the binary snapshot format (magic "FKVB", versioned,
+   // length-prefixed records, trailing checksum). load() sniffs the magic
+   // and falls back to the legacy line-oriented text format for migration.
    bool dump(const std::string &filename);
    bool load(const std::string &filename);
 
+   // Non-blocking snapshot: fork() gives the child a copy-on-write view
+   // on POSIX; elsewhere (or if fork fails) a background thread reuses
+   // the shard-at-a-time dump, so clients are never blocked for the
+   // whole serialization. Returns false if a save is already running.
+   bool bgsave(const std::string &filename);
+   bool bgsaveInProgress() const
+   {
+      return bgsave_running.load(std::memory_order_acquire);
+   }
+
+   /* ============================================================
+      MEMORY ACCOUNTING & EVICTION
+
+      Every insert/overwrite/erase adjusts the owning shard's byte
+      counter (key + value payload + a fixed per-entry overhead
+      estimate), so memoryUsed() is an O(SHARD_COUNT) sum, never a
+      keyspace walk. When maxmemory is set and a write pushes usage
+      over it, the write evicts at most a few keys from its own
+      shard before returning — incremental, so no single command
+      pays for a large reclaim.
+
+      AllkeysLru approximates LRU the sampled-eviction way: reads
+      and writes stamp a per-shard, hash-indexed clock slot (a
+      fixed array of relaxed atomics, safe under the shared lock),
+      and eviction samples a handful of random keys and drops the
+      one with the oldest stamp.
+      ============================================================ */
+   enum class EvictionPolicy
+   {
+      NoEviction,    // writes proceed unbounded (default)
+      AllkeysLru,    // sampled approximate LRU
+      AllkeysRandom, // uniform random victim
+   };
+
+   // Configure before the server starts serving (not thread-safe
+   // against in-flight commands). max_memory of 0 disables the limit.
+   void setMaxMemory(size_t bytes) { max_memory = bytes; }
+   void setEvictionPolicy(EvictionPolicy p) { eviction_policy = p; }
+
+   size_t maxMemory() const { return max_memory; }
+   EvictionPolicy evictionPolicy() const { return eviction_policy; }
+
+   // Approximate bytes charged to stored entries, summed across shards
+   size_t memoryUsed() const;
+
+   // Keys dropped by the eviction path since startup
+   uint64_t evictedKeys() const
+   {
+      return evicted_keys.load(std::memory_order_relaxed);
+   }
+
+   /* ============================================================
+      NEGATIVE-LOOKUP FILTER (opt-in, --negative-filter)
+      ============================================================ */
+   // Per-shard blocked counting filter over string keys, probed by
+   // GET/MGET before taking the shard lock: when the filter says the
+   // key cannot exist, the miss is answered after a few reads of one
+   // cache line, with no lock acquisition. Maintained on every kv
+   // insert/erase; counters saturate rather than underflow, so the
+   // filter can only over-admit (a stale maybe costs one normal
+   // lookup), never report a live key as absent.
+   void enableNegativeFilter();
+
+   bool negativeFilterEnabled() const
+   {
+      return neg_filter_on.load(std::memory_order_acquire);
+   }
+
+   // Probe counters for INFO: consults, and misses answered lock-free
+   uint64_t negFilterChecks() const;
+   uint64_t negFilterSaved() const;
+
+   // Number of lock shards (power of two so routing is a mask)
+   static constexpr size_t SHARD_COUNT = 16;
+
 private:
-   RedisDatabase() = default;
-   ~RedisDatabase() = default;
+   RedisDatabase();  // starts the expiry sweeper thread
+   ~RedisDatabase(); // stops it
 
    RedisDatabase(const RedisDatabase &) = delete;
    RedisDatabase &operator=(const RedisDatabase &) = delete;
@@ -88,24 +231,112 @@ private:
    /* ============================================================
       INTERNAL STATE & HELPERS
       ============================================================ */
-   std::mutex db_mutex; // global lock (simple and safe)
+   // One shard = one lock plus the stores it guards. Every per-key
+   // operation touches exactly one shard; whole-keyspace operations
+   // (keys, dump, load, flushAll) visit shards one at a time.
+   struct Shard
+   {
+      // Reader-writer lock: the read-dominated hot path (GET/HGET/LRANGE)
+      // takes it shared so concurrent readers on a hot shard proceed in
+      // parallel; mutations and expiry purges take it exclusive.
+      std::shared_mutex mutex;
+
+      // Values use the typed/compact encodings from CompactValue.h:
+      // strings that are canonical int64 live as raw integers (KvValue),
+      // small lists/hashes as flat buffers that upgrade as they grow.
+      StringMap<KvValue> kv_store;
+      StringMap<CompactList> list_store;
+      StringMap<CompactHash> hash_store;
+
+      // expiry: key -> wall-clock deadline (system_clock)
+      StringMap<std::chrono::system_clock::time_point> expiry_map;
+
+      // min-heap of (deadline, key) serviced by the sweeper thread, so
+      // expiry work is proportional to what is due, never to keyspace
+      // size. Entries go stale when a deadline is overwritten or the
+      // key is deleted; the sweeper discards those against expiry_map.
+      using ExpiryEntry = std::pair<std::chrono::system_clock::time_point, std::string>;
+      std::priority_queue<ExpiryEntry, std::vector<ExpiryEntry>, std::greater<ExpiryEntry>> expiry_heap;
+
+      // Approximate bytes charged to this shard's entries. Atomic so
+      // memoryUsed() can sum without taking the shard locks; mutations
+      // adjust it while holding the exclusive lock anyway.
+      std::atomic<size_t> mem_used{0};
+
+      // Access-recency sketch for AllkeysLru: key hash -> last-touch
+      // clock. Fixed size and written with relaxed stores, so readers
+      // may stamp it under the *shared* lock without racing a resize;
+      // hash collisions merely blur the approximation.
+      static constexpr size_t LRU_SKETCH_SIZE = 4096;
+      std::array<std::atomic<uint32_t>, LRU_SKETCH_SIZE> lru_sketch{};
 
-   // core stores
-   std::unordered_map<std::string, std::string> kv_store;
-   std::unordered_map<std::string, std::deque<std::string>> list_store;
-   std::unordered_map<std::string, std::unordered_map<std::string, std::string>> hash_store;
+      // Negative-lookup filter counters (null until enabled). Readers
+      // probe without the lock; like the sketch this never resizes, so
+      // relaxed atomic access is safe at any lock strength.
+      std::unique_ptr<std::atomic<uint8_t>[]> neg_filter;
+      std::atomic<uint64_t> neg_checks{0};
+      std::atomic<uint64_t> neg_saved{0};
+   };
 
-   // expiry: key -> wall-clock deadline (system_clock)
-   std::unordered_map<std::string, std::chrono::system_clock::time_point> expiry_map;
+   Shard shards[SHARD_COUNT];
 
-   // Expiry helpers
-   void maybeFullPurge();                          // rate-limited full sweep
-   void purgeExpired_locked();                     // purge (assumes db_mutex held)
-   bool purgeKeyIfExpired(const std::string &key); // per-key purge (caller acquires mutex)
-   bool checkExpired(const std::string &key);
+   // Set while a background save (fork child or snapshot thread) is running
+   std::atomic<bool> bgsave_running{false};
+
+   // maxmemory configuration (see the eviction section above)
+   size_t max_memory = 0;
+   EvictionPolicy eviction_policy = EvictionPolicy::NoEviction;
+   std::atomic<uint64_t> evicted_keys{0};
+
+   std::atomic<bool> neg_filter_on{false};
+
+   // Key -> owning shard (hash routed)
+   size_t shardIndexFor(std::string_view key) const
+   {
+      return std::hash<std::string_view>{}(key) & (SHARD_COUNT - 1);
+   }
+
+   Shard &shardFor(std::string_view key)
+   {
+      return shards[shardIndexFor(key)];
+   }
+
+   // Eviction helpers: touchLru stamps the access sketch (any lock
+   // strength); evictIfNeeded assumes s.mutex is held exclusive and
+   // evicts at most a few keys from s when usage exceeds maxmemory.
+   static void touchLru(Shard &s, std::string_view key);
+   void evictIfNeeded(Shard &s);
+
+   // Expiry helpers (all operate on a single shard)
+   static void purgeExpired_locked(Shard &s); // purge (assumes s.mutex held)
+   static bool checkExpired(Shard &s, std::string_view key);
+
+   // Read-side expiry: isExpired only observes (safe under a shared lock);
+   // when a reader does find an expired key it reports a miss and calls
+   // lazyExpire afterwards, which upgrades to an exclusive lock to purge.
+   static bool isExpired(const Shard &s, std::string_view key);
+   static void lazyExpire(Shard &s, std::string_view key);
+   static void setExpiry_locked(Shard &s, std::string_view key,
+                                std::chrono::system_clock::time_point tp);
+
+   // Dedicated sweeper: pops due heap entries across shards
+   void sweeperLoop();
+
+   std::thread sweeper_thread;
+   std::atomic<bool> sweeper_stop{false};
+   std::condition_variable sweeper_cv;
+   std::mutex sweeper_mutex;
 
    // Small helper to convert ms timestamp -> time_point when loading
    static std::chrono::system_clock::time_point tp_from_ms_since_epoch(long long ms);
+
+   // Snapshot loaders behind load(): binary (mmap; v2 segments load in
+   // parallel, v1 in a single pass) and the legacy text format kept for
+   // migrating old dump files
+   bool loadBinary(const std::string &filename);
+   bool loadBinaryV1(const char *base, size_t size, const std::string &filename);
+   bool loadBinaryV2(const char *base, size_t size, const std::string &filename);
+   bool loadText(const std::string &filename);
 };
 
 #endif // REDIS_DATABASE_H
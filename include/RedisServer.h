@@ -4,6 +4,7 @@
 #include <string>
 #include <atomic>
 #include <memory>
+#include <vector>
 
 #ifdef _WIN32
 #include <winsock2.h>
@@ -20,7 +21,35 @@ class ThreadPool; // Forward declaration
 class RedisServer
 {
 public:
-  explicit RedisServer(int port);
+  // How accepted connections are serviced.
+  //  Events:  a few I/O threads multiplex all sockets (epoll/kqueue);
+  //           scales to thousands of mostly-idle connections.
+  //  Threads: classic thread-per-connection via the ThreadPool (fallback,
+  //           and the only mode on platforms without epoll/kqueue).
+  //  Uring:   Linux io_uring; accept/recv/send run as submitted ops with
+  //           completion-driven dispatch, so a batch of ready sockets
+  //           costs one io_uring_enter instead of one recv+send syscall
+  //           pair per connection. Falls back to Events at startup when
+  //           the kernel (or a seccomp policy) rejects io_uring.
+  enum class IoMode
+  {
+    Events,
+    Threads,
+    Uring
+  };
+
+  // acceptors: number of accept loops. With SO_REUSEPORT each gets its
+  // own listening socket and the kernel spreads incoming connections
+  // across them; where unsupported they share one socket. backlog is the
+  // listen() queue depth per socket (raise it to ride out reconnect
+  // storms after a deploy).
+  // unixsocket: when non-empty, an AF_UNIX listener at that path accepts
+  // co-located clients into the same worker path as TCP — same protocol,
+  // none of the TCP loopback overhead (POSIX only; stale paths are
+  // unlinked on bind and the path is removed on shutdown).
+  explicit RedisServer(int port, IoMode mode = IoMode::Events,
+                       int acceptors = 1, int backlog = 128,
+                       const std::string &unixsocket = "");
   ~RedisServer(); // Ensures proper cleanup
 
   // Start the server: blocking accept() loop
@@ -33,11 +62,39 @@ private:
   int port = 0;
   socket_t server_socket = INVALID_SOCKET_T;
   std::atomic<bool> running{false};
+  IoMode io_mode = IoMode::Events;
+
+  int num_acceptors = 1;
+  int listen_backlog = 128;
+  std::string unix_path; // empty = no unix socket listener
+
+  // Every listening socket; [0] is server_socket. More than one entry
+  // only when SO_REUSEPORT listeners were successfully created.
+  std::vector<socket_t> listen_sockets;
 
   std::unique_ptr<ThreadPool> thread_pool; // Multi-threading support
 
   void setupSignalHandler();
   void handleClient(socket_t client_fd);
+
+  // Creates a bound+listening socket; sets reuseport_ok if SO_REUSEPORT
+  // was requested and actually applied.
+  socket_t createListener(bool want_reuseport, bool &reuseport_ok);
+
+  // Creates the AF_UNIX listener at unix_path (POSIX only)
+  socket_t createUnixListener();
+
+  // Thread-per-connection accept loop (fallback mode), one per acceptor
+  void runAcceptLoop(socket_t listen_fd);
+
+  // Event-loop mode: N I/O threads, each multiplexing its share of sockets
+  void runEventLoop();
+  void eventLoopThread(int thread_index, int io_threads);
+
+  // io_uring mode: N rings, one per I/O thread. Returns false when
+  // io_uring is unavailable so run() can fall back to the event loop.
+  bool runUringLoop();
+  void uringLoopThread(int thread_index, int io_threads);
 };
 
 #endif // REDIS_SERVER_H
@@ -0,0 +1,125 @@
+#ifndef REPLICATION_H
+#define REPLICATION_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "RedisServer.h" // socket_t
+
+// Asynchronous master -> replica replication (POSIX only).
+//
+// The master runs a dedicated replication listener (--repl-port). A
+// replica connects there, sends "SYNC\r\n", and receives the dataset as
+// one RESP bulk string in the snapshot format written by
+// RedisDatabase::dump; after that the master streams every successful
+// mutating command (in its original RESP form, the same frames the AOF
+// records) down the link. The replica loads the snapshot, then applies
+// the stream through its own RedisCommandHandler. Client writes on a
+// replica are rejected with -READONLY; the stream itself bypasses that
+// check via a thread-local flag.
+//
+// Replication is asynchronous: the master never waits for replicas, so
+// a replica lags by whatever is in flight. The stream sink is attached
+// before the snapshot is taken, so no write is lost — but a write that
+// races the snapshot can land in both and be applied twice. That is
+// harmless for SET/HSET/LSET and can skew INCR/LPUSH by one during the
+// initial sync; steady-state replication applies each write once.
+class Replication
+{
+public:
+    static Replication &getInstance();
+
+    // ---- master side ----
+
+    // Bind the replication listener and start the accept thread.
+    // Call after the DB is loaded, before serving clients.
+    bool startMaster(int repl_port);
+
+    // Fan a successful write command out to all attached replicas.
+    // Cheap no-op (one relaxed load) when there are none.
+    void propagate(std::string_view frame);
+
+    // ---- replica side ----
+
+    // REPLICAOF <host> <port>: drop any current link and (re)connect to
+    // the master's replication port in a background thread; the thread
+    // keeps reconnecting with backoff until stopReplication().
+    void replicaOf(const std::string &host, int port);
+
+    // REPLICAOF NO ONE: stop the link thread and resume accepting writes.
+    void stopReplication();
+
+    bool isReplica() const
+    {
+        return replica_mode.load(std::memory_order_acquire);
+    }
+
+    // True while the calling thread is applying the master's stream
+    // (replay path that must bypass the READONLY check)
+    static bool applyingStream();
+
+    // ---- reporting (INFO "# Replication") ----
+    int replicaCount() const
+    {
+        return replica_count.load(std::memory_order_relaxed);
+    }
+    bool linkUp() const
+    {
+        return link_up.load(std::memory_order_relaxed);
+    }
+    std::string masterEndpoint(); // "host:port", empty when master
+
+    void shutdown();
+
+private:
+    Replication() = default;
+    ~Replication() { shutdown(); }
+
+    Replication(const Replication &) = delete;
+    Replication &operator=(const Replication &) = delete;
+
+    // One connected replica on the master. The serve thread sends the
+    // snapshot, then drains buf as propagate() fills it.
+    struct ReplicaLink
+    {
+        socket_t fd = INVALID_SOCKET_T;
+        std::mutex mutex; // guards buf
+        std::condition_variable cv;
+        std::string buf;
+        std::atomic<bool> attached{false}; // receiving propagated frames
+        std::atomic<bool> dead{false};
+        std::thread thread;
+    };
+
+    void acceptLoop();
+    void serveReplica(ReplicaLink *link);
+    void replicaLoop(uint64_t epoch);
+    void reapDeadLinks(); // join + erase links marked dead (accept thread)
+
+    // ---- master state ----
+    std::atomic<bool> master_running{false};
+    socket_t listen_fd = INVALID_SOCKET_T;
+    std::thread accept_thread;
+
+    std::mutex links_mutex;
+    std::vector<std::unique_ptr<ReplicaLink>> links;
+    std::atomic<int> replica_count{0};
+
+    // ---- replica state ----
+    std::atomic<bool> replica_mode{false};
+    std::atomic<bool> link_up{false};
+    std::atomic<uint64_t> link_epoch{0}; // bumped to retire the old thread
+    std::atomic<socket_t> link_fd{INVALID_SOCKET_T};
+    std::mutex repl_mutex; // guards master_host/master_port + thread handoff
+    std::string master_host;
+    int master_port = 0;
+    std::thread replica_thread;
+};
+
+#endif // REPLICATION_H
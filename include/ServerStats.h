@@ -0,0 +1,95 @@
+#ifndef SERVER_STATS_H
+#define SERVER_STATS_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <thread>
+
+/* ============================================================
+   In-process observability: per-command call counters and
+   latency histograms, connection counts, and network byte
+   totals, surfaced through the INFO/STATS command.
+
+   Hot-path counters are striped: each recording thread lands
+   on one of STRIPES cache-line-aligned copies (picked by a
+   cached hash of its thread id), so instrumentation never
+   makes two worker threads bounce the same cache line. render()
+   sums the stripes; the snapshot is approximate by design.
+   ============================================================ */
+class ServerStats
+{
+public:
+    static ServerStats &getInstance();
+
+    static constexpr size_t MAX_COMMANDS = 64;
+    static constexpr size_t STRIPES = 8; // power of two (mask routing)
+
+    // Latency histogram: bucket i counts samples in [2^i, 2^(i+1)) us,
+    // so 24 buckets span 1us .. ~16s.
+    static constexpr size_t LAT_BUCKETS = 24;
+
+    /* ------------ registration (dispatch-table build time) ------------ */
+    // Returns the slot index to pass to recordCommand(). Calling twice
+    // with the same name returns the same slot.
+    size_t registerCommand(std::string_view name);
+
+    /* ----------------------- hot-path recording ----------------------- */
+    void recordCommand(size_t slot, uint64_t latency_us);
+
+    void connectionOpened();
+    void connectionClosed();
+
+    void addBytesIn(uint64_t n);
+    void addBytesOut(uint64_t n);
+
+    /* -------------------------- reporting ----------------------------- */
+    // Serializes a snapshot in redis-INFO style ("section\nkey:value\n").
+    std::string render();
+
+private:
+    ServerStats();
+
+    ServerStats(const ServerStats &) = delete;
+    ServerStats &operator=(const ServerStats &) = delete;
+
+    struct alignas(64) Stripe
+    {
+        std::atomic<uint64_t> calls{0};
+        std::atomic<uint64_t> total_us{0};
+        std::atomic<uint64_t> buckets[LAT_BUCKETS]{};
+    };
+
+    struct CommandSlot
+    {
+        std::string name;
+        Stripe stripes[STRIPES];
+    };
+
+    CommandSlot slots[MAX_COMMANDS];
+    std::atomic<size_t> slot_count{0};
+
+    struct alignas(64) IoStripe
+    {
+        std::atomic<uint64_t> bytes_in{0};
+        std::atomic<uint64_t> bytes_out{0};
+    };
+    IoStripe io[STRIPES];
+
+    std::atomic<long long> connected_clients{0};
+    std::atomic<uint64_t> total_connections{0};
+
+    std::chrono::steady_clock::time_point start_time;
+
+    // Each thread hashes its id once and reuses the stripe index.
+    static size_t stripeIndex()
+    {
+        static thread_local size_t idx =
+            std::hash<std::thread::id>{}(std::this_thread::get_id()) & (STRIPES - 1);
+        return idx;
+    }
+};
+
+#endif // SERVER_STATS_H
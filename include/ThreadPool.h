@@ -1,27 +1,64 @@
-
-// ThreadPool.h - Add this new header
+// ThreadPool.h - work-stealing task scheduler
+//
+// One deque per worker instead of a single mutex/cv-guarded queue, so an
+// enqueue no longer wakes contention across every worker. Owners push and
+// pop at the back of their own deque; idle workers steal from the front of
+// randomly chosen victims. Each deque has its own tiny mutex — the critical
+// sections are a handful of instructions and only contended when a thief
+// actually hits the owner's queue, which keeps unbounded std::function
+// storage simple and safe. The enqueue/shutdown interface is unchanged.
 #ifndef THREAD_POOL_H
 #define THREAD_POOL_H
 
 #include <vector>
-#include <queue>
+#include <deque>
 #include <thread>
 #include <mutex>
 #include <condition_variable>
 #include <functional>
 #include <atomic>
+#include <memory>
+#include <random>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 class ThreadPool
 {
 public:
-    explicit ThreadPool(size_t num_threads = std::thread::hardware_concurrency())
+    // pin_workers: pin worker i to CPU i % hardware_concurrency (Linux only;
+    // a no-op elsewhere). Off by default so the OS scheduler stays in charge.
+    explicit ThreadPool(size_t num_threads = std::thread::hardware_concurrency(),
+                        bool pin_workers = false)
         : stopping(false)
     {
+        if (num_threads == 0)
+            num_threads = 1;
+
+        queues.reserve(num_threads);
+        for (size_t i = 0; i < num_threads; ++i)
+            queues.emplace_back(std::make_unique<WorkerQueue>());
+
         workers.reserve(num_threads);
         for (size_t i = 0; i < num_threads; ++i)
         {
-            workers.emplace_back([this]
-                                 { workerThread(); });
+            workers.emplace_back([this, i]
+                                 { workerThread(i); });
+
+#if defined(__linux__)
+            if (pin_workers)
+            {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(i % std::thread::hardware_concurrency(), &set);
+                pthread_setaffinity_np(workers.back().native_handle(),
+                                       sizeof(set), &set);
+            }
+#else
+            (void)pin_workers;
+#endif
         }
     }
 
@@ -32,31 +69,54 @@ public:
 
     void enqueue(std::function<void()> task)
     {
+        if (stopping.load(std::memory_order_acquire))
+            return;
+
+        // A worker submitting from inside a task keeps it local (hot cache,
+        // no victim traffic); external threads spread round-robin.
+        size_t idx = (tls_pool == this && tls_index >= 0)
+                         ? (size_t)tls_index
+                         : next_queue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+
         {
-            std::lock_guard<std::mutex> lock(queue_mutex);
-            if (stopping.load())
-                return;
-            tasks.push(std::move(task));
+            std::lock_guard<std::mutex> lock(queues[idx]->mutex);
+            queues[idx]->tasks.emplace_back(std::move(task));
         }
-        condition.notify_one();
+
+        idle_cv.notify_one();
     }
 
-    void shutdown()
+    // Batch submission: hand a group of ready tasks over in one pass (one
+    // lock per involved queue), e.g. every client accepted in one poll wake.
+    void enqueueBulk(std::vector<std::function<void()>> tasks)
     {
+        if (tasks.empty() || stopping.load(std::memory_order_acquire))
+            return;
+
+        size_t start = next_queue.fetch_add(tasks.size(), std::memory_order_relaxed);
+
+        for (size_t i = 0; i < tasks.size(); ++i)
         {
-            std::lock_guard<std::mutex> lock(queue_mutex);
-            if (stopping.load())
-                return;
-            stopping.store(true);
+            WorkerQueue &q = *queues[(start + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            q.tasks.emplace_back(std::move(tasks[i]));
         }
-        condition.notify_all();
+
+        idle_cv.notify_all();
+    }
+
+    void shutdown()
+    {
+        bool expected = false;
+        if (!stopping.compare_exchange_strong(expected, true))
+            return;
+
+        idle_cv.notify_all();
 
         for (auto &worker : workers)
         {
             if (worker.joinable())
-            {
                 worker.join();
-            }
         }
     }
 
@@ -66,29 +126,62 @@ public:
     }
 
 private:
-    void workerThread()
+    struct WorkerQueue
     {
-        while (true)
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    bool popLocal(size_t idx, std::function<void()> &out)
+    {
+        WorkerQueue &q = *queues[idx];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.empty())
+            return false;
+        out = std::move(q.tasks.back()); // owner works LIFO (cache-warm)
+        q.tasks.pop_back();
+        return true;
+    }
+
+    bool steal(size_t self, std::function<void()> &out, std::mt19937 &rng)
+    {
+        size_t n = queues.size();
+        if (n <= 1)
+            return false;
+
+        // Random starting victim, then sweep — avoids every idle worker
+        // hammering the same queue.
+        size_t start = rng() % n;
+        for (size_t k = 0; k < n; ++k)
         {
-            std::function<void()> task;
-            {
-                std::unique_lock<std::mutex> lock(queue_mutex);
-                condition.wait(lock, [this]
-                               { return stopping.load() || !tasks.empty(); });
+            size_t v = (start + k) % n;
+            if (v == self)
+                continue;
+
+            WorkerQueue &q = *queues[v];
+            std::lock_guard<std::mutex> lock(q.mutex);
+            if (q.tasks.empty())
+                continue;
+
+            out = std::move(q.tasks.front()); // thieves take FIFO (oldest)
+            q.tasks.pop_front();
+            return true;
+        }
+        return false;
+    }
 
-                if (stopping.load() && tasks.empty())
-                {
-                    return;
-                }
+    void workerThread(size_t idx)
+    {
+        tls_pool = this;
+        tls_index = (int)idx;
 
-                if (!tasks.empty())
-                {
-                    task = std::move(tasks.front());
-                    tasks.pop();
-                }
-            }
+        std::mt19937 rng((unsigned)(idx * 2654435761u + 1));
 
-            if (task)
+        while (true)
+        {
+            std::function<void()> task;
+
+            if (popLocal(idx, task) || steal(idx, task, rng))
             {
                 active_count.fetch_add(1);
                 try
@@ -100,59 +193,35 @@ private:
                     // Log exception but don't crash worker
                 }
                 active_count.fetch_sub(1);
+                continue;
             }
+
+            if (stopping.load(std::memory_order_acquire))
+                return; // nothing local, nothing to steal: drained
+
+            std::unique_lock<std::mutex> lock(idle_mutex);
+            idle_cv.wait_for(lock, std::chrono::milliseconds(10));
         }
     }
 
     std::vector<std::thread> workers;
-    std::queue<std::function<void()>> tasks;
-    std::mutex queue_mutex;
-    std::condition_variable condition;
-    std::atomic<bool> stopping;
-    std::atomic<size_t> active_count{0};
-};
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
 
-#endif // THREAD_POOL_H
+    std::atomic<size_t> next_queue{0};
 
-// ============================================
-// RedisServer.h - Updated
-// ============================================
-#ifndef REDIS_SERVER_H
-#define REDIS_SERVER_H
+    // Only used for parking idle workers; never held while queuing work
+    std::mutex idle_mutex;
+    std::condition_variable idle_cv;
 
-#include <string>
-#include <atomic>
-#include <memory>
-
-#ifdef _WIN32
-#include <winsock2.h>
-#include <ws2tcpip.h>
-using socket_t = SOCKET;
-static constexpr socket_t INVALID_SOCKET_T = INVALID_SOCKET;
-#else
-using socket_t = int;
-static constexpr socket_t INVALID_SOCKET_T = -1;
-#endif
-
-class ThreadPool; // Forward declaration
-
-class RedisServer
-{
-public:
-    explicit RedisServer(int port);
-    ~RedisServer(); // Add destructor
-
-    void run();
-    void shutdown();
-
-private:
-    int port = 0;
-    socket_t server_socket = INVALID_SOCKET_T;
-    std::atomic<bool> running{false};
-    std::unique_ptr<ThreadPool> thread_pool; // Use thread pool
+    std::atomic<bool> stopping;
+    std::atomic<size_t> active_count{0};
 
-    void setupSignalHandler();
-    void handleClient(socket_t client_fd);
+    // Lets enqueue() detect a submission from inside a worker of this pool
+    static thread_local ThreadPool *tls_pool;
+    static thread_local int tls_index;
 };
 
-#endif
\ No newline at end of file
+inline thread_local ThreadPool *ThreadPool::tls_pool = nullptr;
+inline thread_local int ThreadPool::tls_index = -1;
+
+#endif // THREAD_POOL_H
@@ -1,9 +1,13 @@
 #include "../include/RedisCommandHandler.h"
 #include "../include/RedisDatabase.h"
+#include "../include/AofLog.h"
 #include "../include/Logger.h"
+#include "../include/Replication.h"
+#include "../include/ServerStats.h"
 
 #include <algorithm>
 #include <cctype>
+#include <chrono>
 #include <cstring>
 #include <string>
 #include <string_view>
@@ -53,10 +57,10 @@ RedisCommandHandler::RedisCommandHandler() {}
 /* ============================================================================
              RESP PARSER → vector<string_view>
 ============================================================================ */
-std::vector<std::string_view>
+ArenaVector<std::string_view>
 RedisCommandHandler::parseRespViews(std::string_view input)
 {
-    std::vector<std::string_view> out;
+    ArenaVector<std::string_view> out;
     if (input.empty())
         return out;
 
@@ -145,7 +149,7 @@ RedisCommandHandler::parseRespViews(std::string_view input)
               MATERIALIZE string_view → string
 ============================================================================ */
 std::vector<std::string>
-RedisCommandHandler::materialize(const std::vector<std::string_view> &views)
+RedisCommandHandler::materialize(const ArenaVector<std::string_view> &views)
 {
     std::vector<std::string> out;
     out.reserve(views.size());
@@ -163,310 +167,693 @@ std::string RedisCommandHandler::processCommand(const std::string &commandLine)
 }
 
 /* ============================================================================
-                               DISPATCHER
+                     COMMAND HANDLERS (one function per command)
 ============================================================================ */
-std::string RedisCommandHandler::processCommand(std::string_view command)
+// Token vectors live in the thread's arena: freed wholesale at the next
+// frame-batch boundary instead of per command.
+using Tokens = ArenaVector<std::string_view>;
+
+static std::string cmdPing(RedisDatabase &, const Tokens &)
 {
-    auto tokens = parseRespViews(command);
-    if (tokens.empty())
-        return errorString("empty command");
+    return simpleString("PONG");
+}
 
-    std::string cmd(tokens[0]);
-    std::transform(cmd.begin(), cmd.end(), cmd.begin(), ::toupper);
+static std::string cmdEcho(RedisDatabase &, const Tokens &tokens)
+{
+    if (tokens.size() < 2)
+        return errorString("missing arg");
+    return bulkStringView(tokens[1]);
+}
 
-    RedisDatabase &db = RedisDatabase::getInstance();
+static std::string cmdSet(RedisDatabase &db, const Tokens &tokens)
+{
+    if (tokens.size() < 3)
+        return errorString("SET key value");
 
-    /* ------------------------------ PING ----------------------------------- */
-    if (cmd == "PING")
-        return simpleString("PONG");
+    db.set(tokens[1], tokens[2]);
 
-    if (cmd == "ECHO")
+    if (tokens.size() >= 5)
     {
-        if (tokens.size() < 2)
-            return errorString("missing arg");
-        return bulkStringView(tokens[1]);
+        std::string opt(tokens[3]);
+        std::transform(opt.begin(), opt.end(), opt.begin(), ::toupper);
+        int time = std::stoi(std::string(tokens[4]));
+        if (opt == "EX")
+            db.expire(tokens[1], time);
+        else if (opt == "PX")
+            db.expire(tokens[1], (time + 999) / 1000);
     }
 
-    /* ------------------------------ SET ------------------------------------ */
-    if (cmd == "SET")
-    {
-        if (tokens.size() < 3)
-            return errorString("SET key value");
+    return simpleString("OK");
+}
 
-        std::string key(tokens[1]);
-        std::string value(tokens[2]);
-        db.set(key, value);
+static std::string cmdGet(RedisDatabase &db, const Tokens &tokens)
+{
+    if (tokens.size() < 2)
+        return errorString("GET key");
 
-        if (tokens.size() >= 5)
-        {
-            std::string opt(tokens[3]);
-            std::transform(opt.begin(), opt.end(), opt.begin(), ::toupper);
-            int time = std::stoi(std::string(tokens[4]));
-            if (opt == "EX")
-                db.expire(key, time);
-            else if (opt == "PX")
-                db.expire(key, (time + 999) / 1000);
-        }
+    std::string val;
+    if (!db.get(tokens[1], val))
+        return nilBulk();
+    return bulkString(val);
+}
 
-        return simpleString("OK");
-    }
+static std::string cmdMget(RedisDatabase &db, const Tokens &tokens)
+{
+    std::vector<std::string_view> keys(tokens.begin() + 1, tokens.end());
 
-    /* ------------------------------ GET ------------------------------------ */
-    if (cmd == "GET")
-    {
-        if (tokens.size() < 2)
-            return errorString("GET key");
+    std::vector<std::optional<std::string>> vals;
+    db.mget(keys, vals);
 
-        std::string val;
-        if (!db.get(std::string(tokens[1]), val))
-            return nilBulk();
-        return bulkString(val);
-    }
+    std::string out = arrayHeader(vals.size());
+    for (auto &v : vals)
+        out += v ? bulkString(*v) : nilBulk();
+    return out;
+}
 
-    /* ------------------------------ DEL ------------------------------------ */
-    if (cmd == "DEL")
-    {
-        if (tokens.size() < 2)
-            return errorString("DEL key");
-        return integerReply(db.del(std::string(tokens[1])) ? 1 : 0);
-    }
+static std::string cmdMset(RedisDatabase &db, const Tokens &tokens)
+{
+    if (tokens.size() % 2 != 1) // MSET k1 v1 [k2 v2 ...]
+        return errorString("wrong number of arguments for MSET");
 
-    /* ------------------------------ EXPIRE ---------------------------------- */
-    if (cmd == "EXPIRE")
-    {
-        if (tokens.size() < 3)
-            return errorString("EXPIRE key sec");
-        int sec = std::stoi(std::string(tokens[2]));
-        return integerReply(db.expire(std::string(tokens[1]), sec));
-    }
+    std::vector<std::pair<std::string_view, std::string_view>> kvs;
+    kvs.reserve((tokens.size() - 1) / 2);
+    for (size_t i = 1; i + 1 < tokens.size(); i += 2)
+        kvs.emplace_back(tokens[i], tokens[i + 1]);
+
+    db.mset(kvs);
+    return simpleString("OK");
+}
+
+static std::string cmdDel(RedisDatabase &db, const Tokens &tokens)
+{
+    if (tokens.size() < 2)
+        return errorString("DEL key");
+    return integerReply(db.del(tokens[1]) ? 1 : 0);
+}
+
+static std::string cmdExpire(RedisDatabase &db, const Tokens &tokens)
+{
+    if (tokens.size() < 3)
+        return errorString("EXPIRE key sec");
+    int sec = std::stoi(std::string(tokens[2]));
+    return integerReply(db.expire(tokens[1], sec));
+}
 
-    /* =========================================================================
-                            LIST COMMANDS
-    ========================================================================= */
+/* -------------------------- cursor iteration ------------------------------ */
 
-    if (cmd == "LPUSH")
+// Shared option parsing for SCAN/HSCAN: [MATCH pattern] [COUNT n] from `from`
+static bool parseScanOpts(const Tokens &tokens, size_t from,
+                          std::string_view &pattern, size_t &count)
+{
+    for (size_t i = from; i < tokens.size(); i += 2)
     {
-        std::string key(tokens[1]);
-        for (size_t i = 2; i < tokens.size(); i++)
-            db.lpush(key, std::string(tokens[i]));
-        return integerReply(db.llen(key));
+        if (i + 1 >= tokens.size())
+            return false;
+
+        std::string opt(tokens[i]);
+        std::transform(opt.begin(), opt.end(), opt.begin(), ::toupper);
+
+        if (opt == "MATCH")
+            pattern = tokens[i + 1];
+        else if (opt == "COUNT")
+        {
+            try
+            {
+                long long n = std::stoll(std::string(tokens[i + 1]));
+                if (n <= 0)
+                    return false;
+                count = (size_t)n;
+            }
+            catch (...)
+            {
+                return false;
+            }
+        }
+        else
+            return false;
     }
+    return true;
+}
 
-    if (cmd == "RPUSH")
+static std::string cmdScan(RedisDatabase &db, const Tokens &tokens)
+{
+    uint64_t cursor = 0;
+    try
     {
-        std::string key(tokens[1]);
-        for (size_t i = 2; i < tokens.size(); i++)
-            db.rpush(key, std::string(tokens[i]));
-        return integerReply(db.llen(key));
+        cursor = std::stoull(std::string(tokens[1]));
     }
-
-    if (cmd == "LPOP")
+    catch (...)
     {
-        std::string val;
-        if (db.lpop(std::string(tokens[1]), val))
-            return bulkString(val);
-        return nilBulk();
+        return errorString("invalid cursor");
     }
 
-    if (cmd == "RPOP")
+    std::string_view pattern;
+    size_t count = 10;
+    if (!parseScanOpts(tokens, 2, pattern, count))
+        return errorString("syntax error");
+
+    std::vector<std::string> keys;
+    uint64_t next = db.scan(cursor, count, pattern, keys);
+
+    std::string out = arrayHeader(2);
+    out += bulkString(std::to_string(next));
+    out += arrayHeader(keys.size());
+    for (auto &k : keys)
+        out += bulkString(k);
+    return out;
+}
+
+static std::string cmdHscan(RedisDatabase &db, const Tokens &tokens)
+{
+    uint64_t cursor = 0;
+    try
     {
-        std::string val;
-        if (db.rpop(std::string(tokens[1]), val))
-            return bulkString(val);
-        return nilBulk();
+        cursor = std::stoull(std::string(tokens[2]));
     }
-
-    /* ------------------------------ LINDEX --------------------------------- */
-    if (cmd == "LINDEX")
+    catch (...)
     {
-        int idx = std::stoi(std::string(tokens[2]));
-        std::string val;
-        if (db.lindex(std::string(tokens[1]), idx, val))
-            return bulkString(val);
-        return nilBulk();
+        return errorString("invalid cursor");
     }
 
-    /* ------------------------------ LSET ----------------------------------- */
-    if (cmd == "LSET")
+    std::string_view pattern;
+    size_t count = 10;
+    if (!parseScanOpts(tokens, 3, pattern, count))
+        return errorString("syntax error");
+
+    std::vector<std::pair<std::string, std::string>> fields;
+    uint64_t next = db.hscan(tokens[1], cursor, count, pattern, fields);
+
+    std::string out = arrayHeader(2);
+    out += bulkString(std::to_string(next));
+    out += arrayHeader(fields.size() * 2);
+    for (auto &p : fields)
     {
-        int idx = std::stoi(std::string(tokens[2]));
-        if (db.lset(std::string(tokens[1]), idx, std::string(tokens[3])))
-            return simpleString("OK");
-        return errorString("index out of range");
+        out += bulkString(p.first);
+        out += bulkString(p.second);
     }
+    return out;
+}
 
-    /* ------------------------------ LRANGE --------------------------------- */
-    if (cmd == "LRANGE")
-    {
-        std::string key(tokens[1]);
-        int start = std::stoi(std::string(tokens[2]));
-        int stop = std::stoi(std::string(tokens[3]));
+/* ------------------------------- lists ----------------------------------- */
 
-        auto vec = db.lget(key);
-        int n = vec.size();
+static std::string cmdLpush(RedisDatabase &db, const Tokens &tokens)
+{
+    for (size_t i = 2; i < tokens.size(); i++)
+        db.lpush(tokens[1], tokens[i]);
+    return integerReply(db.llen(tokens[1]));
+}
 
-        if (start < 0)
-            start = n + start;
-        if (stop < 0)
-            stop = n + stop;
+static std::string cmdRpush(RedisDatabase &db, const Tokens &tokens)
+{
+    for (size_t i = 2; i < tokens.size(); i++)
+        db.rpush(tokens[1], tokens[i]);
+    return integerReply(db.llen(tokens[1]));
+}
 
-        if (start < 0)
-            start = 0;
-        if (stop >= n)
-            stop = n - 1;
+static std::string cmdLpop(RedisDatabase &db, const Tokens &tokens)
+{
+    std::string val;
+    if (db.lpop(tokens[1], val))
+        return bulkString(val);
+    return nilBulk();
+}
 
-        if (start > stop || start >= n)
-            return arrayHeader(0);
+static std::string cmdRpop(RedisDatabase &db, const Tokens &tokens)
+{
+    std::string val;
+    if (db.rpop(tokens[1], val))
+        return bulkString(val);
+    return nilBulk();
+}
 
-        std::string out = arrayHeader(stop - start + 1);
-        for (int i = start; i <= stop; i++)
-            out += bulkString(vec[i]);
-        return out;
-    }
+static std::string cmdLindex(RedisDatabase &db, const Tokens &tokens)
+{
+    int idx = std::stoi(std::string(tokens[2]));
+    std::string val;
+    if (db.lindex(tokens[1], idx, val))
+        return bulkString(val);
+    return nilBulk();
+}
 
-    /* ------------------------------ LREM ----------------------------------- */
-    if (cmd == "LREM")
-    {
-        if (tokens.size() < 4)
-            return errorString("LREM key count value");
+static std::string cmdLset(RedisDatabase &db, const Tokens &tokens)
+{
+    int idx = std::stoi(std::string(tokens[2]));
+    if (db.lset(tokens[1], idx, tokens[3]))
+        return simpleString("OK");
+    return errorString("index out of range");
+}
 
-        std::string key(tokens[1]);
-        int count = std::stoi(std::string(tokens[2]));
-        std::string value(tokens[3]);
+static std::string cmdLrange(RedisDatabase &db, const Tokens &tokens)
+{
+    int start = std::stoi(std::string(tokens[2]));
+    int stop = std::stoi(std::string(tokens[3]));
 
-        int removed = db.lrem(key, count, value);
-        return integerReply(removed);
-    }
+    // Only the requested window is copied out of the store; a 10-item
+    // LRANGE on a 100k-entry list no longer clones the whole deque.
+    std::vector<std::string> items;
+    db.lrange(tokens[1], start, stop, items);
+
+    std::string out = arrayHeader(items.size());
+    for (auto &v : items)
+        out += bulkString(v);
+    return out;
+}
+
+static std::string cmdLrem(RedisDatabase &db, const Tokens &tokens)
+{
+    if (tokens.size() < 4)
+        return errorString("LREM key count value");
+
+    int count = std::stoi(std::string(tokens[2]));
+
+    int removed = db.lrem(tokens[1], count, tokens[3]);
+    return integerReply(removed);
+}
+
+/* ------------------------------- hashes ---------------------------------- */
 
-    /* =========================================================================
-                            HASH COMMANDS
-    ========================================================================= */
+static std::string cmdHset(RedisDatabase &db, const Tokens &tokens)
+{
+    db.hset(tokens[1], tokens[2], tokens[3]);
+    return integerReply(1);
+}
+
+static std::string cmdHget(RedisDatabase &db, const Tokens &tokens)
+{
+    std::string val;
+    if (db.hget(tokens[1], tokens[2], val))
+        return bulkString(val);
+    return nilBulk();
+}
+
+static std::string cmdHmget(RedisDatabase &db, const Tokens &tokens)
+{
+    std::vector<std::string_view> fields(tokens.begin() + 2, tokens.end());
+
+    std::vector<std::optional<std::string>> vals;
+    db.hmget(tokens[1], fields, vals);
+
+    std::string out = arrayHeader(vals.size());
+    for (auto &v : vals)
+        out += v ? bulkString(*v) : nilBulk();
+    return out;
+}
+
+static std::string cmdHexists(RedisDatabase &db, const Tokens &tokens)
+{
+    return integerReply(db.hexists(tokens[1], tokens[2]));
+}
+
+static std::string cmdHgetall(RedisDatabase &db, const Tokens &tokens)
+{
+    // Serialize straight from the stored hash under its lock (no
+    // intermediate map copy); the header is prepended once the pair
+    // count is known.
+    std::string body;
+    size_t pairs = 0;
+
+    db.hgetall(tokens[1], [&](std::string_view f, std::string_view v)
+               {
+                   body += bulkStringView(f);
+                   body += bulkStringView(v);
+                   pairs++;
+               });
+
+    return arrayHeader(pairs * 2) + body;
+}
+
+static std::string cmdIncr(RedisDatabase &db, const Tokens &tokens)
+{
+    long long v;
+    if (!db.incr(tokens[1], v))
+        return errorString("value is not an integer");
+    return integerReply(v);
+}
+
+/* ----------------------------- persistence -------------------------------- */
+
+static std::string cmdBgsave(RedisDatabase &db, const Tokens &)
+{
+    if (db.bgsave("dump.my_rdb"))
+        return simpleString("Background saving started");
+    return errorString("background save already in progress");
+}
 
-    if (cmd == "HSET")
+static std::string cmdBgrewriteaof(RedisDatabase &, const Tokens &)
+{
+    if (!AofLog::getInstance().isEnabled())
+        return errorString("AOF is not enabled");
+    if (AofLog::getInstance().rewrite())
+        return simpleString("Background append only file rewriting started");
+    return errorString("AOF rewrite already in progress");
+}
+
+/* ---------------------------- replication --------------------------------- */
+
+// REPLICAOF <host> <port> | REPLICAOF NO ONE (SLAVEOF is an alias)
+static std::string cmdReplicaof(RedisDatabase &, const Tokens &tokens)
+{
+    std::string a(tokens[1]), b(tokens[2]);
+    std::transform(a.begin(), a.end(), a.begin(), ::toupper);
+    std::transform(b.begin(), b.end(), b.begin(), ::toupper);
+
+    if (a == "NO" && b == "ONE")
     {
-        db.hset(std::string(tokens[1]), std::string(tokens[2]), std::string(tokens[3]));
-        return integerReply(1);
+        Replication::getInstance().stopReplication();
+        return simpleString("OK");
     }
 
-    if (cmd == "HGET")
+    int port;
+    try
     {
-        std::string val;
-        if (db.hget(std::string(tokens[1]), std::string(tokens[2]), val))
-            return bulkString(val);
-        return nilBulk();
+        port = std::stoi(std::string(tokens[2]));
+    }
+    catch (...)
+    {
+        return errorString("invalid master port");
     }
 
-    if (cmd == "HEXISTS")
-        return integerReply(db.hexists(std::string(tokens[1]), std::string(tokens[2])));
+    Replication::getInstance().replicaOf(std::string(tokens[1]), port);
+    return simpleString("OK");
+}
 
-    if (cmd == "HGETALL")
+/* ------------------------------ stats ------------------------------------- */
+
+static std::string cmdInfo(RedisDatabase &, const Tokens &)
+{
+    return bulkString(ServerStats::getInstance().render());
+}
+
+/* ============================================================================
+                            DISPATCH TABLE
+
+   Command name -> handler + minimum token count (command included).
+   The table is built once; lookup hashes the uppercased token in a stack
+   buffer, so dispatch is O(1) and allocation-free no matter which command
+   is hit (the old if-chain cost ~20 string compares for hash commands).
+============================================================================ */
+namespace
+{
+    struct CommandSpec
+    {
+        std::string (*fn)(RedisDatabase &, const Tokens &);
+        size_t min_tokens;
+        bool is_write;     // mutating commands are appended to the AOF
+        size_t stats_slot; // ServerStats counter slot (filled at table build)
+    };
+
+    const std::unordered_map<std::string_view, CommandSpec> &commandTable()
     {
-        auto map = db.hgetall(std::string(tokens[1]));
-        std::string out = arrayHeader(map.size() * 2);
-        for (auto &p : map)
+        static const std::unordered_map<std::string_view, CommandSpec> table = []
         {
-            out += bulkString(p.first);
-            out += bulkString(p.second);
-        }
-        return out;
+            std::unordered_map<std::string_view, CommandSpec> t = {
+                {"PING", {cmdPing, 1, false, 0}},
+                {"ECHO", {cmdEcho, 1, false, 0}},
+                {"SET", {cmdSet, 1, true, 0}},
+                {"GET", {cmdGet, 1, false, 0}},
+                {"MGET", {cmdMget, 2, false, 0}},
+                {"MSET", {cmdMset, 3, true, 0}},
+                {"DEL", {cmdDel, 1, true, 0}},
+                {"EXPIRE", {cmdExpire, 1, true, 0}},
+                {"SCAN", {cmdScan, 2, false, 0}},
+                {"HSCAN", {cmdHscan, 3, false, 0}},
+                {"LPUSH", {cmdLpush, 3, true, 0}},
+                {"RPUSH", {cmdRpush, 3, true, 0}},
+                {"LPOP", {cmdLpop, 2, true, 0}},
+                {"RPOP", {cmdRpop, 2, true, 0}},
+                {"LINDEX", {cmdLindex, 3, false, 0}},
+                {"LSET", {cmdLset, 4, true, 0}},
+                {"LRANGE", {cmdLrange, 4, false, 0}},
+                {"LREM", {cmdLrem, 1, true, 0}},
+                {"HSET", {cmdHset, 4, true, 0}},
+                {"HGET", {cmdHget, 3, false, 0}},
+                {"HMGET", {cmdHmget, 3, false, 0}},
+                {"HEXISTS", {cmdHexists, 3, false, 0}},
+                {"HGETALL", {cmdHgetall, 2, false, 0}},
+                {"INCR", {cmdIncr, 2, true, 0}},
+                {"REPLICAOF", {cmdReplicaof, 3, false, 0}},
+                {"SLAVEOF", {cmdReplicaof, 3, false, 0}},
+                {"BGSAVE", {cmdBgsave, 1, false, 0}},
+                {"BGREWRITEAOF", {cmdBgrewriteaof, 1, false, 0}},
+                {"INFO", {cmdInfo, 1, false, 0}},
+                {"STATS", {cmdInfo, 1, false, 0}},
+            };
+
+            for (auto &e : t)
+                e.second.stats_slot = ServerStats::getInstance().registerCommand(e.first);
+
+            return t;
+        }();
+        return table;
     }
 
-    /* ------------------------------ INCR ----------------------------------- */
-    if (cmd == "INCR")
+    // Longest command name we dispatch; anything longer is unknown.
+    constexpr size_t MAX_CMD_LEN = 16;
+}
+
+/* ============================================================================
+                               DISPATCHER
+============================================================================ */
+std::string RedisCommandHandler::processCommand(std::string_view command)
+{
+    auto tokens = parseRespViews(command);
+    if (tokens.empty())
+        return errorString("empty command");
+
+    // Uppercase the command token into a stack buffer (no allocation)
+    std::string_view raw = tokens[0];
+    char upbuf[MAX_CMD_LEN];
+
+    if (raw.size() <= MAX_CMD_LEN)
     {
-        long long v;
-        if (!db.incr(std::string(tokens[1]), v))
-            return errorString("value is not an integer");
-        return integerReply(v);
+        for (size_t i = 0; i < raw.size(); i++)
+            upbuf[i] = (char)::toupper((unsigned char)raw[i]);
+
+        std::string_view cmd(upbuf, raw.size());
+
+        auto it = commandTable().find(cmd);
+        if (it != commandTable().end())
+        {
+            if (tokens.size() < it->second.min_tokens)
+                return errorString("wrong number of arguments");
+
+            // Replicas only take writes from the master's stream; reads
+            // and admin commands are served locally as usual.
+            if (it->second.is_write && Replication::getInstance().isReplica() &&
+                !Replication::applyingStream())
+                return "-READONLY You can't write against a read only replica.\r\n";
+
+            auto t0 = std::chrono::steady_clock::now();
+            std::string resp = it->second.fn(RedisDatabase::getInstance(), tokens);
+            auto t1 = std::chrono::steady_clock::now();
+
+            ServerStats::getInstance().recordCommand(
+                it->second.stats_slot,
+                std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count());
+
+            // Successful mutations are logged in their original RESP form
+            // and fanned out to any connected replicas
+            if (it->second.is_write && !resp.empty() && resp[0] != '-')
+            {
+                if (AofLog::getInstance().isEnabled())
+                    AofLog::getInstance().append(command);
+                Replication::getInstance().propagate(command);
+            }
+
+            return resp;
+        }
     }
 
-    Logger::getInstance().warn("Unknown command: " + cmd);
+    Logger::getInstance().warn("Unknown command: " + std::string(raw));
     return errorString("unknown command");
 }
 
 /* ============================================================================
-                      FRAME SPLITTER (RESP)
+                      FRAME SPLITTER (RESP, incremental)
+
+   State machine over the connection buffer. Progress through a partial
+   frame (element count, remaining bulk bytes) survives across calls, so
+   when a client streams a multi-megabyte bulk value each new recv chunk
+   advances bulk_left_ by the bytes that just arrived — no re-scan of
+   what was already validated. The dead prefix of emitted frames is kept
+   as the consumed_ offset and only compacted when it grows past
+   COMPACT_THRESHOLD (or the whole buffer has been consumed, which just
+   clears it), instead of memmoving the tail on every call.
 ============================================================================ */
-std::vector<std::string>
+RedisCommandHandler::RespFrames
 RedisCommandHandler::splitFrames(std::string &buffer)
 {
-    std::vector<std::string> frames;
-    size_t cursor = 0;
-    size_t n = buffer.size();
     const size_t MAX_FRAMES = 1000;
-    size_t count = 0;
+    const size_t COMPACT_THRESHOLD = 64 * 1024;
 
-    while (cursor < n && count < MAX_FRAMES)
-    {
-        if (buffer[cursor] != '*')
-        {
-            size_t nl = buffer.find("\r\n", cursor);
-            if (nl == std::string::npos)
-                break;
+    /* ---------------- batch boundary ----------------
+       The previous batch's frames and token vectors are dead by now:
+       recycle the thread arena wholesale, then deal with the buffer
+       prefix those frames pointed into (deferred from the last call so
+       the views stayed valid while the batch was processed). */
+    Arena::threadLocal().reset();
 
-            frames.emplace_back(buffer.substr(cursor, nl + 2 - cursor));
-            cursor = nl + 2;
-            count++;
-            continue;
-        }
+    if (consumed_ >= buffer.size())
+    {
+        buffer.clear();
+        consumed_ = 0;
+        scan_ = 0;
+    }
+    else if (consumed_ >= COMPACT_THRESHOLD)
+    {
+        buffer.erase(0, consumed_);
+        scan_ -= consumed_;
+        consumed_ = 0;
+    }
 
-        size_t rn = buffer.find("\r\n", cursor + 1);
-        if (rn == std::string::npos)
-            break;
+    RespFrames frames;
+    const size_t n = buffer.size();
 
-        int elements = 0;
-        try
+    // Parse the decimal after a '*' or '$' at [pos+1, rn); npos result on junk
+    auto parseCount = [&](size_t pos, size_t rn, long long &out) -> bool
+    {
+        out = 0;
+        bool neg = false;
+        size_t i = pos + 1;
+        if (i < rn && buffer[i] == '-')
         {
-            elements = std::stoi(buffer.substr(cursor + 1, rn - cursor - 1));
+            neg = true;
+            i++;
         }
-        catch (...)
+        if (i >= rn)
+            return false;
+        for (; i < rn; i++)
         {
-            break;
+            char c = buffer[i];
+            if (c < '0' || c > '9')
+                return false;
+            out = out * 10 + (c - '0');
+            if (out > 1'000'000'000)
+                return false;
         }
+        if (neg)
+            out = -out;
+        return true;
+    };
 
-        if (elements <= 0 || elements > 1'000'000)
-            break;
+    while (frames.size() < MAX_FRAMES)
+    {
+        /* ---------------- between frames: sniff the next one ---------------- */
+        if (elems_left_ == -1)
+        {
+            if (consumed_ >= n)
+                break;
 
-        size_t pos = rn + 2;
-        bool ok = true;
+            if (scan_ < consumed_)
+                scan_ = consumed_;
 
-        for (int i = 0; i < elements; i++)
-        {
-            if (pos >= n || buffer[pos] != '$')
+            if (buffer[consumed_] != '*')
             {
-                ok = false;
-                break;
+                // Inline command: one CRLF-terminated line. Resume the CRLF
+                // search where the previous call left off (scan_).
+                size_t from = scan_ > consumed_ ? scan_ - 1 : consumed_; // '\r' may straddle chunks
+                size_t nl = buffer.find("\r\n", from);
+                if (nl == std::string::npos)
+                {
+                    scan_ = n; // everything seen, still no terminator
+                    break;
+                }
+
+                frames.emplace_back(buffer.data() + consumed_, nl + 2 - consumed_);
+                consumed_ = nl + 2;
+                scan_ = consumed_;
+                continue;
             }
 
-            size_t rn2 = buffer.find("\r\n", pos + 1);
-            if (rn2 == std::string::npos)
+            // Array header "*<count>\r\n"
+            size_t from = scan_ > consumed_ ? scan_ - 1 : consumed_;
+            size_t rn = buffer.find("\r\n", from);
+            if (rn == std::string::npos)
             {
-                ok = false;
+                scan_ = n;
                 break;
             }
 
-            int len = std::stoi(buffer.substr(pos + 1, rn2 - pos - 1));
+            long long elements = 0;
+            if (!parseCount(consumed_, rn, elements) ||
+                elements <= 0 || elements > 1'000'000)
+                break; // malformed header: leave bytes for the caller's size cap
 
-            pos = rn2 + 2;
-            if (pos + len + 2 > n)
+            elems_left_ = (int)elements;
+            bulk_left_ = -1;
+            scan_ = rn + 2;
+            continue;
+        }
+
+        /* ---------------- inside a frame: consume elements ---------------- */
+        bool progress = true;
+        while (elems_left_ > 0 && progress)
+        {
+            if (bulk_left_ == -1)
             {
-                ok = false;
-                break;
+                // Expect "$<len>\r\n" at scan_. Header lines are short, so
+                // re-searching from the header start on a later call is O(1).
+                if (scan_ >= n)
+                {
+                    progress = false;
+                    break;
+                }
+                if (buffer[scan_] != '$')
+                {
+                    elems_left_ = -1; // protocol error: resync at next frame
+                    progress = false;
+                    break;
+                }
+
+                size_t rn = buffer.find("\r\n", scan_ + 1);
+                if (rn == std::string::npos)
+                {
+                    progress = false;
+                    break;
+                }
+
+                long long len = 0;
+                if (!parseCount(scan_, rn, len) || len < 0 || len > 512LL * 1024 * 1024)
+                {
+                    elems_left_ = -1;
+                    progress = false;
+                    break;
+                }
+
+                scan_ = rn + 2;
+                bulk_left_ = len + 2; // payload + trailing CRLF
+            }
+            else
+            {
+                // Swallow as much of the pending payload as has arrived
+                size_t avail = n - scan_;
+                size_t take = (size_t)std::min<long long>(bulk_left_, (long long)avail);
+                scan_ += take;
+                bulk_left_ -= take;
+
+                if (bulk_left_ > 0)
+                {
+                    progress = false; // need more bytes
+                    break;
+                }
+
+                bulk_left_ = -1;
+                elems_left_--;
             }
-
-            pos += len + 2;
         }
 
-        if (!ok)
-            break;
+        if (elems_left_ == 0)
+        {
+            frames.emplace_back(buffer.data() + consumed_, scan_ - consumed_);
+            consumed_ = scan_;
+            elems_left_ = -1;
+            continue;
+        }
 
-        frames.emplace_back(buffer.substr(cursor, pos - cursor));
-        cursor = pos;
-        count++;
+        break; // partial frame: state is saved for the next call
     }
 
-    if (cursor > 0)
-        buffer.erase(0, cursor);
-
+    // Consumed-prefix cleanup happens at the start of the next call, once
+    // the views handed out here are no longer live.
     return frames;
 }
@@ -1,13 +1,28 @@
 // src/RedisDatabase.cpp
 #include "../include/RedisDatabase.h"
+#include "../include/CoarseClock.h"
 #include "../include/Logger.h"
 
 #include <fstream>
 #include <sstream>
 #include <algorithm>
 #include <chrono>
+#include <cerrno>
+#include <cstdio>
 #include <cstring>
 #include <stdexcept>
+#include <thread>
+#include <random>
+
+#include <cstdint>
+
+#ifndef _WIN32
+#include <unistd.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#endif
 
 using sys_clock = std::chrono::system_clock;
 
@@ -20,87 +35,444 @@ RedisDatabase &RedisDatabase::getInstance()
     return inst;
 }
 
-/* -----------------------------------------------------------------------------
-   Expiry sweep (safe & race-free)
------------------------------------------------------------------------------ */
-static constexpr std::chrono::milliseconds SWEEP_INTERVAL{1000};
-static sys_clock::time_point last_sweep = sys_clock::now() - SWEEP_INTERVAL;
+RedisDatabase::RedisDatabase()
+{
+    sweeper_thread = std::thread([this]()
+                                 { sweeperLoop(); });
+}
+
+RedisDatabase::~RedisDatabase()
+{
+    sweeper_stop.store(true, std::memory_order_release);
+    sweeper_cv.notify_all();
+    if (sweeper_thread.joinable())
+        sweeper_thread.join();
+}
 
 namespace
 {
+    // Coarse clock: one relaxed load instead of a clock call per check;
+    // a key can outlive its deadline by ~CoarseClock::TICK_MS at most.
     inline bool tp_expired(const sys_clock::time_point &tp)
     {
-        return sys_clock::now() >= tp;
+        return CoarseClock::now() >= tp;
+    }
+
+    /* -------------------------------------------------------------------------
+       Heterogeneous-map helpers: all lookups go through string_view; a
+       std::string key is only constructed when an entry is actually inserted.
+       (unordered_map::erase/operator[] don't take string_view before C++23,
+       hence the find-first pattern.)
+    ------------------------------------------------------------------------- */
+    template <typename Map>
+    inline bool eraseKey(Map &m, std::string_view key)
+    {
+        auto it = m.find(key);
+        if (it == m.end())
+            return false;
+        m.erase(it);
+        return true;
+    }
+
+    template <typename Map, typename V>
+    inline void upsert(Map &m, std::string_view key, V &&value)
+    {
+        auto it = m.find(key);
+        if (it != m.end())
+            it->second = std::forward<V>(value);
+        else
+            m.emplace(std::string(key), std::forward<V>(value));
+    }
+
+    template <typename Map>
+    inline typename Map::mapped_type &getOrCreate(Map &m, std::string_view key)
+    {
+        auto it = m.find(key);
+        if (it == m.end())
+            it = m.emplace(std::string(key), typename Map::mapped_type{}).first;
+        return it->second;
+    }
+
+    /* -------------------------------------------------------------------------
+       Memory accounting: every store entry is charged key bytes + value
+       payload (the wrappers track their own) + a fixed per-entry estimate
+       for the map node and string headers. Mutations adjust the owning
+       shard's counter by (after - before); size_t modular arithmetic makes
+       the negative case work with a single fetch_add.
+    ------------------------------------------------------------------------- */
+    constexpr size_t KEY_OVERHEAD = 64;
+
+    template <typename V>
+    inline size_t entryUsage(std::string_view key, const V &v)
+    {
+        return KEY_OVERHEAD + key.size() + v.memUsage();
+    }
+
+    inline void chargeMem(std::atomic<size_t> &mem, size_t after, size_t before)
+    {
+        mem.fetch_add(after - before, std::memory_order_relaxed);
+    }
+
+    // Eviction tuning: keys reclaimed per over-limit write, and sample
+    // size for the approximate-LRU victim pick (Redis uses 5 too).
+    constexpr int EVICT_BATCH = 4;
+    constexpr int EVICT_SAMPLES = 5;
+
+    // Seconds since process start — coarse enough for recency ordering,
+    // and (via the cached clock) free to stamp on every access.
+    inline uint32_t lruClock()
+    {
+        return (uint32_t)(CoarseClock::steadyMs() / 1000);
+    }
+
+    /* -------------------------------------------------------------------------
+       Negative-lookup filter geometry: 256 KB of one-byte counters per
+       shard, grouped into 64-counter blocks so a membership probe reads a
+       single cache line. Each key maps to one block and NEG_PROBES slots
+       within it; a slot's counter is bumped per resident key, so "any
+       slot is zero" proves absence. Saturated counters (255) are never
+       decremented — the filter degrades toward admitting more, never
+       toward a false absent. The block index comes from hash bits above
+       the ones shard routing consumes, so a shard's keys spread over the
+       whole filter.
+    ------------------------------------------------------------------------- */
+    constexpr size_t NEG_FILTER_COUNTERS = 256 * 1024; // per shard
+    constexpr size_t NEG_FILTER_BLOCKS = NEG_FILTER_COUNTERS / 64;
+    constexpr int NEG_PROBES = 3;
+
+    inline std::atomic<uint8_t> *negBlock(std::atomic<uint8_t> *f,
+                                          std::string_view key, uint64_t &h)
+    {
+        h = std::hash<std::string_view>{}(key);
+        return f + ((h >> 16) & (NEG_FILTER_BLOCKS - 1)) * 64;
+    }
+
+    inline size_t negSlot(uint64_t h, int i) { return (h >> (32 + 6 * i)) & 63; }
+
+    inline void negFilterAdd(std::atomic<uint8_t> *f, std::string_view key)
+    {
+        uint64_t h;
+        std::atomic<uint8_t> *b = negBlock(f, key, h);
+        for (int i = 0; i < NEG_PROBES; i++)
+        {
+            std::atomic<uint8_t> &c = b[negSlot(h, i)];
+            uint8_t v = c.load(std::memory_order_relaxed);
+            while (v < 255 &&
+                   !c.compare_exchange_weak(v, v + 1, std::memory_order_relaxed))
+                ;
+        }
+    }
+
+    inline void negFilterRemove(std::atomic<uint8_t> *f, std::string_view key)
+    {
+        uint64_t h;
+        std::atomic<uint8_t> *b = negBlock(f, key, h);
+        for (int i = 0; i < NEG_PROBES; i++)
+        {
+            std::atomic<uint8_t> &c = b[negSlot(h, i)];
+            uint8_t v = c.load(std::memory_order_relaxed);
+            while (v > 0 && v < 255 &&
+                   !c.compare_exchange_weak(v, v - 1, std::memory_order_relaxed))
+                ;
+        }
+    }
+
+    inline bool negFilterMayContain(const std::atomic<uint8_t> *f,
+                                    std::string_view key)
+    {
+        uint64_t h;
+        const std::atomic<uint8_t> *b =
+            negBlock(const_cast<std::atomic<uint8_t> *>(f), key, h);
+        for (int i = 0; i < NEG_PROBES; i++)
+            if (b[negSlot(h, i)].load(std::memory_order_relaxed) == 0)
+                return false;
+        return true;
     }
 }
 
 /* -----------------------------------------------------------------------------
-   Internal helper: fast delete of all data types for key
+   Internal helper: fast delete of all data types for key, refunding the
+   erased entry's bytes to the shard's memory counter
 ----------------------------------------------------------------------------- */
 inline void fastErase(
-    const std::string &key,
-    std::unordered_map<std::string, std::string> &kv,
-    std::unordered_map<std::string, std::deque<std::string>> &lists,
-    std::unordered_map<std::string, std::unordered_map<std::string, std::string>> &hash)
+    std::string_view key,
+    StringMap<KvValue> &kv,
+    StringMap<CompactList> &lists,
+    StringMap<CompactHash> &hash,
+    std::atomic<size_t> &mem,
+    std::atomic<uint8_t> *neg_filter)
 {
-    if (!kv.erase(key))
-        if (!lists.erase(key))
-            hash.erase(key);
+    if (auto it = kv.find(key); it != kv.end())
+    {
+        mem.fetch_sub(entryUsage(it->first, it->second), std::memory_order_relaxed);
+        if (neg_filter)
+            negFilterRemove(neg_filter, key);
+        kv.erase(it);
+        return;
+    }
+    if (auto it = lists.find(key); it != lists.end())
+    {
+        mem.fetch_sub(entryUsage(it->first, it->second), std::memory_order_relaxed);
+        lists.erase(it);
+        return;
+    }
+    if (auto it = hash.find(key); it != hash.end())
+    {
+        mem.fetch_sub(entryUsage(it->first, it->second), std::memory_order_relaxed);
+        hash.erase(it);
+    }
 }
 
 /* -----------------------------------------------------------------------------
-   Internal helper: check & purge single key expiration
+   Internal helper: check & purge single key expiration (shard mutex held)
 ----------------------------------------------------------------------------- */
-bool RedisDatabase::checkExpired(const std::string &key)
+bool RedisDatabase::checkExpired(Shard &s, std::string_view key)
 {
-    auto it = expiry_map.find(key);
-    if (it != expiry_map.end() && tp_expired(it->second))
+    auto it = s.expiry_map.find(key);
+    if (it != s.expiry_map.end() && tp_expired(it->second))
     {
-        fastErase(key, kv_store, list_store, hash_store);
-        expiry_map.erase(it);
+        fastErase(key, s.kv_store, s.list_store, s.hash_store, s.mem_used, s.neg_filter.get());
+        s.expiry_map.erase(it);
         return true;
     }
     return false;
 }
 
 /* -----------------------------------------------------------------------------
-   Full purge (rate-limited)
+   Read-side expiry. Readers hold the shard lock shared, so they may only
+   observe: isExpired checks the deadline without purging. When a reader
+   does hit an expired key it reports a miss, drops the shared lock, and
+   calls lazyExpire, which takes the lock exclusively to purge — so the
+   common case (key live or absent) never needs write access.
 ----------------------------------------------------------------------------- */
-void RedisDatabase::maybeFullPurge()
+bool RedisDatabase::isExpired(const Shard &s, std::string_view key)
 {
-    auto now = sys_clock::now();
-    if (now - last_sweep < SWEEP_INTERVAL)
-        return;
+    auto it = s.expiry_map.find(key);
+    return it != s.expiry_map.end() && tp_expired(it->second);
+}
+
+void RedisDatabase::lazyExpire(Shard &s, std::string_view key)
+{
+    std::lock_guard<std::shared_mutex> lock(s.mutex);
+    checkExpired(s, key);
+}
+
+/* -----------------------------------------------------------------------------
+   Expiry bookkeeping: the map holds the authoritative deadline, the heap
+   orders keys by deadline for the sweeper. Overwritten deadlines leave a
+   stale heap entry behind; the sweeper validates every popped entry
+   against the map before acting on it.
+----------------------------------------------------------------------------- */
+void RedisDatabase::setExpiry_locked(Shard &s, std::string_view key, sys_clock::time_point tp)
+{
+    upsert(s.expiry_map, key, tp);
+    s.expiry_heap.emplace(tp, std::string(key));
+}
+
+/* -----------------------------------------------------------------------------
+   Dedicated sweeper thread: pops only due heap entries, so cost scales
+   with the number of expiring keys, never with keyspace size.
+----------------------------------------------------------------------------- */
+void RedisDatabase::sweeperLoop()
+{
+    while (!sweeper_stop.load(std::memory_order_acquire))
+    {
+        {
+            std::unique_lock<std::mutex> lk(sweeper_mutex);
+            sweeper_cv.wait_for(lk, std::chrono::milliseconds(100));
+        }
+
+        auto now = CoarseClock::now();
+
+        for (auto &s : shards)
+        {
+            std::lock_guard<std::shared_mutex> lock(s.mutex);
 
-    last_sweep = now; // no mutex → no deadlock risk
+            while (!s.expiry_heap.empty() && s.expiry_heap.top().first <= now)
+            {
+                auto entry = s.expiry_heap.top();
+                s.expiry_heap.pop();
+
+                auto it = s.expiry_map.find(entry.second);
+                if (it == s.expiry_map.end() || it->second != entry.first)
+                    continue; // stale: deadline overwritten or key deleted
 
-    std::lock_guard<std::mutex> lock(db_mutex);
-    purgeExpired_locked();
+                fastErase(entry.second, s.kv_store, s.list_store, s.hash_store, s.mem_used, s.neg_filter.get());
+                s.expiry_map.erase(it);
+            }
+        }
+    }
 }
 
-void RedisDatabase::purgeExpired_locked()
+void RedisDatabase::purgeExpired_locked(Shard &s)
 {
-    for (auto it = expiry_map.begin(); it != expiry_map.end();)
+    for (auto it = s.expiry_map.begin(); it != s.expiry_map.end();)
     {
         if (tp_expired(it->second))
         {
-            fastErase(it->first, kv_store, list_store, hash_store);
-            it = expiry_map.erase(it);
+            fastErase(it->first, s.kv_store, s.list_store, s.hash_store, s.mem_used, s.neg_filter.get());
+            it = s.expiry_map.erase(it);
         }
         else
             ++it;
     }
 }
 
-bool RedisDatabase::purgeKeyIfExpired(const std::string &key)
+sys_clock::time_point RedisDatabase::tp_from_ms_since_epoch(long long ms)
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
-    return checkExpired(key);
+    return sys_clock::time_point(std::chrono::milliseconds(ms));
 }
 
-sys_clock::time_point RedisDatabase::tp_from_ms_since_epoch(long long ms)
+/* -----------------------------------------------------------------------------
+   Memory accounting & maxmemory eviction.
+
+   memoryUsed() sums the per-shard counters that every mutation maintains,
+   so checking the limit is O(SHARD_COUNT) loads. An over-limit write
+   reclaims at most EVICT_BATCH keys from its own shard before returning;
+   sustained pressure spreads eviction across subsequent writes (and
+   shards), so no single command absorbs a large reclaim.
+----------------------------------------------------------------------------- */
+size_t RedisDatabase::memoryUsed() const
 {
-    return sys_clock::time_point(std::chrono::milliseconds(ms));
+    size_t total = 0;
+    for (auto &s : shards)
+        total += s.mem_used.load(std::memory_order_relaxed);
+    return total;
+}
+
+/* -----------------------------------------------------------------------------
+   Negative-lookup filter (see the geometry notes with the helpers above).
+   enableNegativeFilter allocates each shard's counters and seeds them
+   from the keys already resident, so it can be turned on after a load.
+----------------------------------------------------------------------------- */
+void RedisDatabase::enableNegativeFilter()
+{
+    if (neg_filter_on.load(std::memory_order_acquire))
+        return;
+
+    for (auto &s : shards)
+    {
+        std::lock_guard<std::shared_mutex> lock(s.mutex);
+        s.neg_filter = std::make_unique<std::atomic<uint8_t>[]>(NEG_FILTER_COUNTERS);
+        for (auto &kv : s.kv_store)
+            negFilterAdd(s.neg_filter.get(), kv.first);
+    }
+
+    neg_filter_on.store(true, std::memory_order_release);
+    Logger::getInstance().info("Negative-lookup filter enabled (" +
+                               std::to_string(NEG_FILTER_COUNTERS * SHARD_COUNT / 1024) +
+                               " KB)");
+}
+
+uint64_t RedisDatabase::negFilterChecks() const
+{
+    uint64_t total = 0;
+    for (auto &s : shards)
+        total += s.neg_checks.load(std::memory_order_relaxed);
+    return total;
+}
+
+uint64_t RedisDatabase::negFilterSaved() const
+{
+    uint64_t total = 0;
+    for (auto &s : shards)
+        total += s.neg_saved.load(std::memory_order_relaxed);
+    return total;
+}
+
+void RedisDatabase::touchLru(Shard &s, std::string_view key)
+{
+    size_t slot = std::hash<std::string_view>{}(key) % Shard::LRU_SKETCH_SIZE;
+    // +1 so a never-touched slot (0) always looks older than any real stamp
+    s.lru_sketch[slot].store(lruClock() + 1, std::memory_order_relaxed);
+}
+
+void RedisDatabase::evictIfNeeded(Shard &s)
+{
+    if (max_memory == 0 || eviction_policy == EvictionPolicy::NoEviction)
+        return;
+    if (memoryUsed() <= max_memory)
+        return;
+
+    static thread_local std::mt19937 rng{std::random_device{}()};
+
+    // Uniform-ish random live key from this shard: pick a store weighted
+    // by entry count, then probe a few buckets from a random start. The
+    // probe is bounded; begin() is the fallback for very sparse tables.
+    auto randomKey = [&]() -> std::string
+    {
+        size_t nk = s.kv_store.size();
+        size_t nl = s.list_store.size();
+        size_t nh = s.hash_store.size();
+        size_t total = nk + nl + nh;
+        if (total == 0)
+            return {};
+
+        size_t pick = rng() % total;
+
+        auto fromMap = [&](auto &m) -> std::string
+        {
+            size_t nb = m.bucket_count();
+            if (nb != 0)
+            {
+                size_t b = rng() % nb;
+                for (size_t probe = 0; probe < 32 && probe < nb; probe++)
+                {
+                    size_t idx = (b + probe) % nb;
+                    auto it = m.begin(idx);
+                    if (it != m.end(idx))
+                        return it->first;
+                }
+            }
+            auto it = m.begin();
+            return it != m.end() ? it->first : std::string{};
+        };
+
+        if (pick < nk)
+            return fromMap(s.kv_store);
+        if (pick < nk + nl)
+            return fromMap(s.list_store);
+        return fromMap(s.hash_store);
+    };
+
+    for (int round = 0; round < EVICT_BATCH; round++)
+    {
+        if (memoryUsed() <= max_memory)
+            return;
+
+        std::string victim;
+
+        if (eviction_policy == EvictionPolicy::AllkeysRandom)
+        {
+            victim = randomKey();
+        }
+        else // AllkeysLru: sample a few keys, evict the stalest stamp
+        {
+            uint32_t oldest = UINT32_MAX;
+            for (int i = 0; i < EVICT_SAMPLES; i++)
+            {
+                std::string k = randomKey();
+                if (k.empty())
+                    break;
+
+                size_t slot = std::hash<std::string_view>{}(std::string_view(k)) %
+                              Shard::LRU_SKETCH_SIZE;
+                uint32_t stamp = s.lru_sketch[slot].load(std::memory_order_relaxed);
+                if (stamp <= oldest)
+                {
+                    oldest = stamp;
+                    victim = std::move(k);
+                }
+            }
+        }
+
+        if (victim.empty())
+            return; // shard drained; other shards' writes take over
+
+        fastErase(victim, s.kv_store, s.list_store, s.hash_store, s.mem_used, s.neg_filter.get());
+        eraseKey(s.expiry_map, victim);
+        evicted_keys.fetch_add(1, std::memory_order_relaxed);
+    }
 }
 
 /* -----------------------------------------------------------------------------
@@ -108,163 +480,547 @@ sys_clock::time_point RedisDatabase::tp_from_ms_since_epoch(long long ms)
 ----------------------------------------------------------------------------- */
 bool RedisDatabase::flushAll()
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
-    kv_store.clear();
-    list_store.clear();
-    hash_store.clear();
-    expiry_map.clear();
+    for (auto &s : shards)
+    {
+        std::lock_guard<std::shared_mutex> lock(s.mutex);
+        s.kv_store.clear();
+        s.list_store.clear();
+        s.hash_store.clear();
+        s.expiry_map.clear();
+        s.expiry_heap = {};
+        s.mem_used.store(0, std::memory_order_relaxed);
+        if (s.neg_filter)
+            for (size_t i = 0; i < NEG_FILTER_COUNTERS; i++)
+                s.neg_filter[i].store(0, std::memory_order_relaxed);
+    }
     return true;
 }
 
 /* -----------------------------------------------------------------------------
    STRING OPERATIONS
 ----------------------------------------------------------------------------- */
-void RedisDatabase::set(const std::string &key, const std::string &value)
+void RedisDatabase::set(std::string_view key, std::string_view value)
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
-    kv_store[key] = value;
+    Shard &s = shardFor(key);
+    std::lock_guard<std::shared_mutex> lock(s.mutex);
+
+    auto it = s.kv_store.find(key);
+    if (it != s.kv_store.end())
+    {
+        size_t before = it->second.memUsage();
+        it->second.assign(value);
+        chargeMem(s.mem_used, it->second.memUsage(), before);
+    }
+    else
+    {
+        auto &v = s.kv_store.emplace(std::string(key), KvValue(value)).first->second;
+        s.mem_used.fetch_add(entryUsage(key, v), std::memory_order_relaxed);
+        if (s.neg_filter)
+            negFilterAdd(s.neg_filter.get(), key);
+    }
+
+    touchLru(s, key);
+    evictIfNeeded(s);
 }
 
-bool RedisDatabase::get(const std::string &key, std::string &value)
+bool RedisDatabase::get(std::string_view key, std::string &value)
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
+    Shard &s = shardFor(key);
 
-    if (checkExpired(key))
-        return false;
+    // Filter first: a proven-absent key never touches the lock
+    if (neg_filter_on.load(std::memory_order_acquire))
+    {
+        s.neg_checks.fetch_add(1, std::memory_order_relaxed);
+        if (!negFilterMayContain(s.neg_filter.get(), key))
+        {
+            s.neg_saved.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
 
-    auto it = kv_store.find(key);
-    if (it == kv_store.end())
-        return false;
+    {
+        std::shared_lock<std::shared_mutex> lock(s.mutex);
 
-    value = it->second;
-    return true;
+        if (!isExpired(s, key))
+        {
+            auto it = s.kv_store.find(key);
+            if (it == s.kv_store.end())
+                return false;
+
+            value = it->second.toString();
+            touchLru(s, key);
+            return true;
+        }
+    }
+
+    lazyExpire(s, key);
+    return false;
+}
+
+/* ------------------------------------------------------------
+   Batch accessors (MGET/MSET): keys are bucketed by owning
+   shard first, then each shard is locked exactly once and all
+   of its lookups/stores run inside that single critical
+   section, amortizing lock and cache-miss costs across the
+   batch instead of paying them per key.
+   ------------------------------------------------------------ */
+void RedisDatabase::mget(const std::vector<std::string_view> &keysIn,
+                         std::vector<std::optional<std::string>> &out)
+{
+    out.assign(keysIn.size(), std::nullopt);
+
+    // bucket the original indices by shard; filter-proven misses are
+    // answered here and never enter a critical section
+    const bool filtered = neg_filter_on.load(std::memory_order_acquire);
+    std::vector<size_t> byShard[SHARD_COUNT];
+    for (size_t i = 0; i < keysIn.size(); i++)
+    {
+        size_t sh = shardIndexFor(keysIn[i]);
+        if (filtered)
+        {
+            Shard &s = shards[sh];
+            s.neg_checks.fetch_add(1, std::memory_order_relaxed);
+            if (!negFilterMayContain(s.neg_filter.get(), keysIn[i]))
+            {
+                s.neg_saved.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+        }
+        byShard[sh].push_back(i);
+    }
+
+    for (size_t sh = 0; sh < SHARD_COUNT; sh++)
+    {
+        if (byShard[sh].empty())
+            continue;
+
+        Shard &s = shards[sh];
+        std::vector<size_t> expired;
+
+        {
+            std::shared_lock<std::shared_mutex> lock(s.mutex);
+
+            for (size_t i : byShard[sh])
+            {
+                std::string_view key = keysIn[i];
+                if (isExpired(s, key))
+                {
+                    expired.push_back(i);
+                    continue;
+                }
+
+                auto it = s.kv_store.find(key);
+                if (it != s.kv_store.end())
+                {
+                    out[i] = it->second.toString();
+                    touchLru(s, key);
+                }
+            }
+        }
+
+        for (size_t i : expired)
+            lazyExpire(s, keysIn[i]);
+    }
 }
 
-bool RedisDatabase::del(const std::string &key)
+void RedisDatabase::mset(const std::vector<std::pair<std::string_view, std::string_view>> &kvs)
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
+    std::vector<size_t> byShard[SHARD_COUNT];
+    for (size_t i = 0; i < kvs.size(); i++)
+        byShard[shardIndexFor(kvs[i].first)].push_back(i);
+
+    for (size_t sh = 0; sh < SHARD_COUNT; sh++)
+    {
+        if (byShard[sh].empty())
+            continue;
+
+        Shard &s = shards[sh];
+        std::lock_guard<std::shared_mutex> lock(s.mutex);
+
+        for (size_t i : byShard[sh])
+        {
+            auto it = s.kv_store.find(kvs[i].first);
+            if (it != s.kv_store.end())
+            {
+                size_t before = it->second.memUsage();
+                it->second.assign(kvs[i].second);
+                chargeMem(s.mem_used, it->second.memUsage(), before);
+            }
+            else
+            {
+                auto &v = s.kv_store.emplace(std::string(kvs[i].first),
+                                             KvValue(kvs[i].second))
+                              .first->second;
+                s.mem_used.fetch_add(entryUsage(kvs[i].first, v), std::memory_order_relaxed);
+                if (s.neg_filter)
+                    negFilterAdd(s.neg_filter.get(), kvs[i].first);
+            }
+            touchLru(s, kvs[i].first);
+        }
+
+        evictIfNeeded(s);
+    }
+}
+
+bool RedisDatabase::del(std::string_view key)
+{
+    Shard &s = shardFor(key);
+    std::lock_guard<std::shared_mutex> lock(s.mutex);
 
     bool removed = false;
-    if (kv_store.erase(key) > 0)
+    if (auto it = s.kv_store.find(key); it != s.kv_store.end())
+    {
+        s.mem_used.fetch_sub(entryUsage(it->first, it->second), std::memory_order_relaxed);
+        if (s.neg_filter)
+            negFilterRemove(s.neg_filter.get(), key);
+        s.kv_store.erase(it);
         removed = true;
-    if (list_store.erase(key) > 0)
+    }
+    if (auto it = s.list_store.find(key); it != s.list_store.end())
+    {
+        s.mem_used.fetch_sub(entryUsage(it->first, it->second), std::memory_order_relaxed);
+        s.list_store.erase(it);
         removed = true;
-    if (hash_store.erase(key) > 0)
+    }
+    if (auto it = s.hash_store.find(key); it != s.hash_store.end())
+    {
+        s.mem_used.fetch_sub(entryUsage(it->first, it->second), std::memory_order_relaxed);
+        s.hash_store.erase(it);
         removed = true;
+    }
 
-    expiry_map.erase(key);
+    eraseKey(s.expiry_map, key);
     return removed;
 }
 
 std::vector<std::string> RedisDatabase::keys()
 {
-    maybeFullPurge();
-
-    std::lock_guard<std::mutex> lock(db_mutex);
     std::vector<std::string> out;
-    out.reserve(kv_store.size() + list_store.size() + hash_store.size());
 
-    for (auto &p : kv_store)
-        out.push_back(p.first);
-    for (auto &p : list_store)
-        out.push_back(p.first);
-    for (auto &p : hash_store)
-        out.push_back(p.first);
+    for (auto &s : shards)
+    {
+        std::shared_lock<std::shared_mutex> lock(s.mutex);
+        out.reserve(out.size() + s.kv_store.size() + s.list_store.size() + s.hash_store.size());
+
+        for (auto &p : s.kv_store)
+            out.push_back(p.first);
+        for (auto &p : s.list_store)
+            out.push_back(p.first);
+        for (auto &p : s.hash_store)
+            out.push_back(p.first);
+    }
 
     return out;
 }
 
-std::string RedisDatabase::type(const std::string &key)
+/* -----------------------------------------------------------------------------
+   SCAN / HSCAN — cursor-based iteration
+
+   Cursor layout: [63:56] store (0 kv, 1 list, 2 hash), [55:48] shard,
+   [47:0] bucket index within that store's unordered_map. Each call walks
+   whole buckets until ~count keys are collected, then pauses at a bucket
+   boundary, so the shard lock is held for O(count) work. A rehash between
+   calls invalidates bucket positions (entries may be missed or repeated,
+   as with Redis SCAN); an out-of-range bucket just finishes that store.
+----------------------------------------------------------------------------- */
+namespace
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
+    // Glob matcher supporting '*' and '?' with iterative '*' backtracking
+    bool globMatch(std::string_view pat, std::string_view str)
+    {
+        size_t p = 0, s = 0;
+        size_t star_p = std::string_view::npos, star_s = 0;
 
-    if (checkExpired(key))
-        return "none";
+        while (s < str.size())
+        {
+            if (p < pat.size() && (pat[p] == '?' || pat[p] == str[s]))
+            {
+                p++;
+                s++;
+            }
+            else if (p < pat.size() && pat[p] == '*')
+            {
+                star_p = p++;
+                star_s = s;
+            }
+            else if (star_p != std::string_view::npos)
+            {
+                p = star_p + 1;
+                s = ++star_s;
+            }
+            else
+            {
+                return false;
+            }
+        }
 
-    if (kv_store.count(key))
-        return "string";
-    if (list_store.count(key))
-        return "list";
-    if (hash_store.count(key))
-        return "hash";
+        while (p < pat.size() && pat[p] == '*')
+            p++;
+        return p == pat.size();
+    }
+
+    constexpr uint64_t SCAN_STORE_SHIFT = 56;
+    constexpr uint64_t SCAN_SHARD_SHIFT = 48;
+    constexpr uint64_t SCAN_BUCKET_MASK = (1ULL << SCAN_SHARD_SHIFT) - 1;
+}
 
+uint64_t RedisDatabase::scan(uint64_t cursor, size_t count, std::string_view pattern,
+                             std::vector<std::string> &out)
+{
+    if (count == 0)
+        count = 10;
+
+    size_t store = (size_t)(cursor >> SCAN_STORE_SHIFT);
+    size_t shard = (size_t)((cursor >> SCAN_SHARD_SHIFT) & 0xFF);
+    size_t bucket = (size_t)(cursor & SCAN_BUCKET_MASK);
+
+    while (store < 3)
+    {
+        if (shard >= SHARD_COUNT)
+        {
+            store++;
+            shard = 0;
+            bucket = 0;
+            continue;
+        }
+
+        Shard &s = shards[shard];
+        bool paused = false;
+
+        {
+            std::shared_lock<std::shared_mutex> lock(s.mutex);
+
+            // Walk whole buckets of one store until the batch is full
+            auto walk = [&](auto &m)
+            {
+                size_t nb = m.bucket_count();
+                while (bucket < nb)
+                {
+                    for (auto it = m.begin(bucket); it != m.end(bucket); ++it)
+                    {
+                        if (isExpired(s, it->first))
+                            continue;
+                        if (pattern.empty() || globMatch(pattern, it->first))
+                            out.push_back(it->first);
+                    }
+                    bucket++;
+
+                    if (out.size() >= count && bucket < nb)
+                    {
+                        paused = true;
+                        return;
+                    }
+                }
+            };
+
+            switch (store)
+            {
+            case 0:
+                walk(s.kv_store);
+                break;
+            case 1:
+                walk(s.list_store);
+                break;
+            default:
+                walk(s.hash_store);
+                break;
+            }
+        }
+
+        if (paused)
+            return ((uint64_t)store << SCAN_STORE_SHIFT) |
+                   ((uint64_t)shard << SCAN_SHARD_SHIFT) | (uint64_t)bucket;
+
+        // Finished this store on this shard: advance
+        shard++;
+        bucket = 0;
+
+        if (out.size() >= count)
+        {
+            if (shard >= SHARD_COUNT)
+            {
+                store++;
+                shard = 0;
+            }
+            if (store >= 3)
+                return 0;
+            return ((uint64_t)store << SCAN_STORE_SHIFT) |
+                   ((uint64_t)shard << SCAN_SHARD_SHIFT);
+        }
+    }
+
+    return 0;
+}
+
+uint64_t RedisDatabase::hscan(std::string_view key, uint64_t cursor, size_t count,
+                              std::string_view pattern,
+                              std::vector<std::pair<std::string, std::string>> &out)
+{
+    if (count == 0)
+        count = 10;
+
+    Shard &s = shardFor(key);
+    std::shared_lock<std::shared_mutex> lock(s.mutex);
+
+    if (isExpired(s, key))
+        return 0;
+
+    auto it = s.hash_store.find(key);
+    if (it == s.hash_store.end())
+        return 0;
+
+    return it->second.scanStep(cursor, count,
+                               [&](std::string_view f, std::string_view v)
+                               {
+                                   if (!pattern.empty() && !globMatch(pattern, f))
+                                       return false;
+                                   out.emplace_back(std::string(f), std::string(v));
+                                   return true;
+                               });
+}
+
+void RedisDatabase::storeSizes(size_t &kv, size_t &lists, size_t &hashes)
+{
+    kv = lists = hashes = 0;
+
+    for (auto &s : shards)
+    {
+        std::shared_lock<std::shared_mutex> lock(s.mutex);
+        kv += s.kv_store.size();
+        lists += s.list_store.size();
+        hashes += s.hash_store.size();
+    }
+}
+
+std::string RedisDatabase::type(std::string_view key)
+{
+    Shard &s = shardFor(key);
+    {
+        std::shared_lock<std::shared_mutex> lock(s.mutex);
+
+        if (!isExpired(s, key))
+        {
+            if (s.kv_store.find(key) != s.kv_store.end())
+                return "string";
+            if (s.list_store.find(key) != s.list_store.end())
+                return "list";
+            if (s.hash_store.find(key) != s.hash_store.end())
+                return "hash";
+
+            return "none";
+        }
+    }
+
+    lazyExpire(s, key);
     return "none";
 }
 
 /* -----------------------------------------------------------------------------
    EXPIRATION
 ----------------------------------------------------------------------------- */
-bool RedisDatabase::expire(const std::string &key, int seconds)
+bool RedisDatabase::expire(std::string_view key, int seconds)
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
+    Shard &s = shardFor(key);
+    std::lock_guard<std::shared_mutex> lock(s.mutex);
 
-    if (!(kv_store.count(key) || list_store.count(key) || hash_store.count(key)))
+    if (s.kv_store.find(key) == s.kv_store.end() &&
+        s.list_store.find(key) == s.list_store.end() &&
+        s.hash_store.find(key) == s.hash_store.end())
         return false;
 
-    expiry_map[key] = sys_clock::now() + std::chrono::seconds(seconds);
+    setExpiry_locked(s, key, sys_clock::now() + std::chrono::seconds(seconds));
     return true;
 }
 
-int RedisDatabase::ttl(const std::string &key)
+int RedisDatabase::ttl(std::string_view key)
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
-
-    auto it = expiry_map.find(key);
-    if (it == expiry_map.end())
+    Shard &s = shardFor(key);
     {
-        if (kv_store.count(key) || list_store.count(key) || hash_store.count(key))
-            return -1; // exists, no TTL
-        return -2;     // does not exist
-    }
+        std::shared_lock<std::shared_mutex> lock(s.mutex);
 
-    if (tp_expired(it->second))
-    {
-        fastErase(key, kv_store, list_store, hash_store);
-        expiry_map.erase(it);
-        return -2;
+        auto it = s.expiry_map.find(key);
+        if (it == s.expiry_map.end())
+        {
+            if (s.kv_store.find(key) != s.kv_store.end() ||
+                s.list_store.find(key) != s.list_store.end() ||
+                s.hash_store.find(key) != s.hash_store.end())
+                return -1; // exists, no TTL
+            return -2;     // does not exist
+        }
+
+        if (!tp_expired(it->second))
+            return (int)std::chrono::duration_cast<std::chrono::seconds>(it->second - sys_clock::now()).count();
     }
 
-    return (int)std::chrono::duration_cast<std::chrono::seconds>(it->second - sys_clock::now()).count();
+    lazyExpire(s, key);
+    return -2;
 }
 
 /* -----------------------------------------------------------------------------
    RENAME
 ----------------------------------------------------------------------------- */
-bool RedisDatabase::rename(const std::string &oldKey, const std::string &newKey)
+bool RedisDatabase::rename(std::string_view oldKey, std::string_view newKey)
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
+    Shard &src = shardFor(oldKey);
+    Shard &dst = shardFor(newKey);
+
+    // Lock both shards in address order to avoid deadlock with a
+    // concurrent rename in the opposite direction.
+    std::unique_lock<std::shared_mutex> lock_src(src.mutex, std::defer_lock);
+    std::unique_lock<std::shared_mutex> lock_dst(dst.mutex, std::defer_lock);
+
+    if (&src == &dst)
+        lock_src.lock();
+    else if (&src < &dst)
+    {
+        lock_src.lock();
+        lock_dst.lock();
+    }
+    else
+    {
+        lock_dst.lock();
+        lock_src.lock();
+    }
 
     // Clear new key always
-    fastErase(newKey, kv_store, list_store, hash_store);
-    expiry_map.erase(newKey);
+    fastErase(newKey, dst.kv_store, dst.list_store, dst.hash_store, dst.mem_used, dst.neg_filter.get());
+    eraseKey(dst.expiry_map, newKey);
 
     bool found = false;
 
-    if (auto it = kv_store.find(oldKey); it != kv_store.end())
+    // Each move refunds the source shard and charges the destination
+    // (payload is unchanged; only the key bytes differ).
+    auto moveEntry = [&](auto &src_store, auto &dst_store) -> bool
     {
-        kv_store[newKey] = std::move(it->second);
-        kv_store.erase(it);
-        found = true;
-    }
+        auto it = src_store.find(oldKey);
+        if (it == src_store.end())
+            return false;
+
+        size_t payload = it->second.memUsage();
+        src.mem_used.fetch_sub(entryUsage(it->first, it->second), std::memory_order_relaxed);
+        upsert(dst_store, newKey, std::move(it->second));
+        src_store.erase(it);
+        dst.mem_used.fetch_add(KEY_OVERHEAD + newKey.size() + payload, std::memory_order_relaxed);
+        return true;
+    };
 
-    if (auto it = list_store.find(oldKey); it != list_store.end())
+    if (moveEntry(src.kv_store, dst.kv_store))
     {
-        list_store[newKey] = std::move(it->second);
-        list_store.erase(it);
         found = true;
+        if (src.neg_filter)
+            negFilterRemove(src.neg_filter.get(), oldKey);
+        if (dst.neg_filter)
+            negFilterAdd(dst.neg_filter.get(), newKey);
     }
-
-    if (auto it = hash_store.find(oldKey); it != hash_store.end())
-    {
-        hash_store[newKey] = std::move(it->second);
-        hash_store.erase(it);
+    if (moveEntry(src.list_store, dst.list_store))
+        found = true;
+    if (moveEntry(src.hash_store, dst.hash_store))
         found = true;
-    }
 
-    if (auto it = expiry_map.find(oldKey); it != expiry_map.end())
+    if (auto it = src.expiry_map.find(oldKey); it != src.expiry_map.end())
     {
-        expiry_map[newKey] = it->second;
-        expiry_map.erase(it);
+        setExpiry_locked(dst, newKey, it->second);
+        src.expiry_map.erase(it);
     }
 
     return found;
@@ -273,379 +1029,549 @@ bool RedisDatabase::rename(const std::string &oldKey, const std::string &newKey)
 /* -----------------------------------------------------------------------------
    LIST OPERATIONS  (all TTL safe)
 ----------------------------------------------------------------------------- */
-std::vector<std::string> RedisDatabase::lget(const std::string &key)
+std::vector<std::string> RedisDatabase::lget(std::string_view key)
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
-
-    if (checkExpired(key))
-        return {};
+    Shard &s = shardFor(key);
+    {
+        std::shared_lock<std::shared_mutex> lock(s.mutex);
 
-    auto it = list_store.find(key);
-    if (it == list_store.end())
-        return {};
+        if (!isExpired(s, key))
+        {
+            auto it = s.list_store.find(key);
+            if (it == s.list_store.end())
+                return {};
+
+            std::vector<std::string> out;
+            out.reserve(it->second.size());
+            it->second.forEach([&](std::string_view v)
+                               { out.emplace_back(v); });
+            return out;
+        }
+    }
 
-    return std::vector<std::string>(it->second.begin(), it->second.end());
+    lazyExpire(s, key);
+    return {};
 }
 
-ssize_t RedisDatabase::llen(const std::string &key)
+void RedisDatabase::lrange(std::string_view key, int start, int stop,
+                           std::vector<std::string> &out)
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
+    out.clear();
 
-    if (checkExpired(key))
-        return 0;
+    Shard &s = shardFor(key);
+    {
+        std::shared_lock<std::shared_mutex> lock(s.mutex);
+
+        if (!isExpired(s, key))
+        {
+            auto it = s.list_store.find(key);
+            if (it == s.list_store.end())
+                return;
+
+            int n = (int)it->second.size();
+
+            if (start < 0)
+                start += n;
+            if (stop < 0)
+                stop += n;
+            if (start < 0)
+                start = 0;
+            if (stop >= n)
+                stop = n - 1;
+
+            if (start > stop || start >= n)
+                return;
+
+            out.reserve((size_t)(stop - start + 1));
+            it->second.forRange((size_t)start, (size_t)stop,
+                                [&](std::string_view v)
+                                { out.emplace_back(v); });
+            touchLru(s, key);
+            return;
+        }
+    }
 
-    auto it = list_store.find(key);
-    return (it == list_store.end()) ? 0 : it->second.size();
+    lazyExpire(s, key);
 }
 
-void RedisDatabase::lpush(const std::string &key, const std::string &value)
+ssize_t RedisDatabase::llen(std::string_view key)
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
-
-    if (checkExpired(key))
+    Shard &s = shardFor(key);
     {
-        // create new list
-        list_store[key].push_front(value);
-        return;
+        std::shared_lock<std::shared_mutex> lock(s.mutex);
+
+        if (!isExpired(s, key))
+        {
+            auto it = s.list_store.find(key);
+            return (it == s.list_store.end()) ? 0 : it->second.size();
+        }
     }
 
-    list_store[key].push_front(value);
+    lazyExpire(s, key);
+    return 0;
 }
 
-void RedisDatabase::rpush(const std::string &key, const std::string &value)
+void RedisDatabase::lpush(std::string_view key, std::string_view value)
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
+    Shard &s = shardFor(key);
+    std::lock_guard<std::shared_mutex> lock(s.mutex);
 
-    if (checkExpired(key))
-    {
-        list_store[key].push_back(value);
-        return;
-    }
+    checkExpired(s, key);
 
-    list_store[key].push_back(value);
+    auto it = s.list_store.find(key);
+    size_t before = (it != s.list_store.end()) ? entryUsage(key, it->second) : 0;
+    if (it == s.list_store.end())
+        it = s.list_store.emplace(std::string(key), CompactList{}).first;
+
+    it->second.push_front(value);
+    chargeMem(s.mem_used, entryUsage(key, it->second), before);
+
+    touchLru(s, key);
+    evictIfNeeded(s);
 }
 
-int RedisDatabase::lrem(const std::string &key, int count, const std::string &value)
+void RedisDatabase::rpush(std::string_view key, std::string_view value)
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
+    Shard &s = shardFor(key);
+    std::lock_guard<std::shared_mutex> lock(s.mutex);
+
+    checkExpired(s, key);
 
-    if (checkExpired(key))
+    auto it = s.list_store.find(key);
+    size_t before = (it != s.list_store.end()) ? entryUsage(key, it->second) : 0;
+    if (it == s.list_store.end())
+        it = s.list_store.emplace(std::string(key), CompactList{}).first;
+
+    it->second.push_back(value);
+    chargeMem(s.mem_used, entryUsage(key, it->second), before);
+
+    touchLru(s, key);
+    evictIfNeeded(s);
+}
+
+int RedisDatabase::lrem(std::string_view key, int count, std::string_view value)
+{
+    Shard &s = shardFor(key);
+    std::lock_guard<std::shared_mutex> lock(s.mutex);
+
+    if (checkExpired(s, key))
         return 0;
 
-    auto it = list_store.find(key);
-    if (it == list_store.end())
+    auto it = s.list_store.find(key);
+    if (it == s.list_store.end())
         return 0;
 
     auto &lst = it->second;
+
+    // Materialize once, filter, and hand the survivors back wholesale
+    // (assignFrom re-picks the compact/deque representation).
+    std::deque<std::string> items;
+    lst.forEach([&](std::string_view v)
+                { items.emplace_back(v); });
+
     int removed = 0;
+    std::deque<std::string> newList;
 
-    if (count == 0)
+    if (count >= 0)
     {
-        std::deque<std::string> newList;
-        for (auto &v : lst)
+        for (auto &v : items)
         {
-            if (v == value)
+            if (v == value && (count == 0 || removed < count))
                 removed++;
             else
-                newList.push_back(v);
+                newList.push_back(std::move(v));
         }
-        lst.swap(newList);
-        return removed;
     }
-
-    if (count > 0)
+    else
     {
-        std::deque<std::string> newList;
-        for (auto &v : lst)
+        int target = -count;
+        for (auto it2 = items.rbegin(); it2 != items.rend(); ++it2)
         {
-            if (v == value && removed < count)
+            if (*it2 == value && removed < target)
+            {
                 removed++;
-            else
-                newList.push_back(v);
+                continue;
+            }
+            newList.push_front(std::move(*it2));
         }
-        lst.swap(newList);
-        return removed;
     }
 
-    int target = -count;
-    std::deque<std::string> newList;
-    for (auto it2 = lst.rbegin(); it2 != lst.rend(); ++it2)
-    {
-        if (*it2 == value && removed < target)
-        {
-            removed++;
-            continue;
-        }
-        newList.push_front(*it2);
-    }
-    lst.swap(newList);
+    size_t before = lst.memUsage();
+    lst.assignFrom(std::move(newList));
+    chargeMem(s.mem_used, lst.memUsage(), before);
     return removed;
 }
 
-bool RedisDatabase::lpop(const std::string &key, std::string &value)
+bool RedisDatabase::lpop(std::string_view key, std::string &value)
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
+    Shard &s = shardFor(key);
+    std::lock_guard<std::shared_mutex> lock(s.mutex);
 
-    if (checkExpired(key))
+    if (checkExpired(s, key))
         return false;
 
-    auto it = list_store.find(key);
-    if (it == list_store.end() || it->second.empty())
+    auto it = s.list_store.find(key);
+    if (it == s.list_store.end())
         return false;
 
-    value = std::move(it->second.front());
-    it->second.pop_front();
-    return true;
+    size_t before = it->second.memUsage();
+    bool ok = it->second.pop_front(value);
+    chargeMem(s.mem_used, it->second.memUsage(), before);
+    return ok;
 }
 
-bool RedisDatabase::rpop(const std::string &key, std::string &value)
+bool RedisDatabase::rpop(std::string_view key, std::string &value)
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
+    Shard &s = shardFor(key);
+    std::lock_guard<std::shared_mutex> lock(s.mutex);
 
-    if (checkExpired(key))
+    if (checkExpired(s, key))
         return false;
 
-    auto it = list_store.find(key);
-    if (it == list_store.end() || it->second.empty())
+    auto it = s.list_store.find(key);
+    if (it == s.list_store.end())
         return false;
 
-    value = std::move(it->second.back());
-    it->second.pop_back();
-    return true;
+    size_t before = it->second.memUsage();
+    bool ok = it->second.pop_back(value);
+    chargeMem(s.mem_used, it->second.memUsage(), before);
+    return ok;
 }
 
-bool RedisDatabase::lindex(const std::string &key, int index, std::string &value)
+bool RedisDatabase::lindex(std::string_view key, int index, std::string &value)
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
+    Shard &s = shardFor(key);
+    {
+        std::shared_lock<std::shared_mutex> lock(s.mutex);
 
-    if (checkExpired(key))
-        return false;
+        if (!isExpired(s, key))
+        {
+            auto it = s.list_store.find(key);
+            if (it == s.list_store.end())
+                return false;
 
-    auto it = list_store.find(key);
-    if (it == list_store.end())
-        return false;
+            auto &lst = it->second;
+            int sz = (int)lst.size();
 
-    auto &lst = it->second;
-    int sz = lst.size();
+            if (index < 0)
+                index += sz;
+            if (index < 0 || index >= sz)
+                return false;
 
-    if (index < 0)
-        index += sz;
-    if (index < 0 || index >= sz)
-        return false;
+            return lst.index((size_t)index, value);
+        }
+    }
 
-    value = lst[index];
-    return true;
+    lazyExpire(s, key);
+    return false;
 }
 
-bool RedisDatabase::lset(const std::string &key, int index, const std::string &value)
+bool RedisDatabase::lset(std::string_view key, int index, std::string_view value)
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
+    Shard &s = shardFor(key);
+    std::lock_guard<std::shared_mutex> lock(s.mutex);
 
-    if (checkExpired(key))
+    if (checkExpired(s, key))
         return false;
 
-    auto it = list_store.find(key);
-    if (it == list_store.end())
+    auto it = s.list_store.find(key);
+    if (it == s.list_store.end())
         return false;
 
     auto &lst = it->second;
-    int sz = lst.size();
+    int sz = (int)lst.size();
 
     if (index < 0)
         index += sz;
     if (index < 0 || index >= sz)
         return false;
 
-    lst[index] = value;
-    return true;
+    size_t before = lst.memUsage();
+    bool ok = lst.assign((size_t)index, value);
+    chargeMem(s.mem_used, lst.memUsage(), before);
+    return ok;
 }
 
 /* -----------------------------------------------------------------------------
    HASH OPERATIONS (all TTL safe)
 ----------------------------------------------------------------------------- */
-bool RedisDatabase::hset(const std::string &key, const std::string &field, const std::string &value)
+bool RedisDatabase::hset(std::string_view key, std::string_view field, std::string_view value)
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
+    Shard &s = shardFor(key);
+    std::lock_guard<std::shared_mutex> lock(s.mutex);
+
+    checkExpired(s, key);
+
+    auto it = s.hash_store.find(key);
+    size_t before = (it != s.hash_store.end()) ? entryUsage(key, it->second) : 0;
+    if (it == s.hash_store.end())
+        it = s.hash_store.emplace(std::string(key), CompactHash{}).first;
+
+    it->second.set(field, value);
+    chargeMem(s.mem_used, entryUsage(key, it->second), before);
+
+    touchLru(s, key);
+    evictIfNeeded(s);
+    return true;
+}
 
-    if (checkExpired(key))
+bool RedisDatabase::hget(std::string_view key, std::string_view field, std::string &value)
+{
+    Shard &s = shardFor(key);
     {
-        hash_store[key][field] = value;
-        return true;
+        std::shared_lock<std::shared_mutex> lock(s.mutex);
+
+        if (!isExpired(s, key))
+        {
+            auto it = s.hash_store.find(key);
+            if (it == s.hash_store.end())
+                return false;
+
+            if (!it->second.get(field, value))
+                return false;
+
+            touchLru(s, key);
+            return true;
+        }
     }
 
-    hash_store[key][field] = value;
-    return true;
+    lazyExpire(s, key);
+    return false;
 }
 
-bool RedisDatabase::hget(const std::string &key, const std::string &field, std::string &value)
+// HMGET: one shard, one lock, all field lookups inside it.
+void RedisDatabase::hmget(std::string_view key,
+                          const std::vector<std::string_view> &fields,
+                          std::vector<std::optional<std::string>> &out)
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
+    out.assign(fields.size(), std::nullopt);
 
-    if (checkExpired(key))
-        return false;
+    Shard &s = shardFor(key);
+    {
+        std::shared_lock<std::shared_mutex> lock(s.mutex);
 
-    auto it = hash_store.find(key);
-    if (it == hash_store.end())
-        return false;
+        if (!isExpired(s, key))
+        {
+            auto it = s.hash_store.find(key);
+            if (it == s.hash_store.end())
+                return;
 
-    auto f = it->second.find(field);
-    if (f == it->second.end())
-        return false;
+            for (size_t i = 0; i < fields.size(); i++)
+            {
+                std::string v;
+                if (it->second.get(fields[i], v))
+                    out[i] = std::move(v);
+            }
+            return;
+        }
+    }
 
-    value = f->second;
-    return true;
+    lazyExpire(s, key);
 }
 
-bool RedisDatabase::hexists(const std::string &key, const std::string &field)
+bool RedisDatabase::hexists(std::string_view key, std::string_view field)
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
+    Shard &s = shardFor(key);
+    {
+        std::shared_lock<std::shared_mutex> lock(s.mutex);
 
-    if (checkExpired(key))
-        return false;
+        if (!isExpired(s, key))
+        {
+            auto it = s.hash_store.find(key);
+            return (it != s.hash_store.end() && it->second.contains(field));
+        }
+    }
 
-    auto it = hash_store.find(key);
-    return (it != hash_store.end() && it->second.count(field) > 0);
+    lazyExpire(s, key);
+    return false;
 }
 
-bool RedisDatabase::hdel(const std::string &key, const std::string &field)
+bool RedisDatabase::hdel(std::string_view key, std::string_view field)
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
+    Shard &s = shardFor(key);
+    std::lock_guard<std::shared_mutex> lock(s.mutex);
 
-    if (checkExpired(key))
+    if (checkExpired(s, key))
         return false;
 
-    auto it = hash_store.find(key);
-    if (it == hash_store.end())
+    auto it = s.hash_store.find(key);
+    if (it == s.hash_store.end())
         return false;
 
-    return (it->second.erase(field) > 0);
+    size_t before = it->second.memUsage();
+    bool ok = it->second.erase(field);
+    chargeMem(s.mem_used, it->second.memUsage(), before);
+    return ok;
 }
 
-std::unordered_map<std::string, std::string> RedisDatabase::hgetall(const std::string &key)
+std::unordered_map<std::string, std::string> RedisDatabase::hgetall(std::string_view key)
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
+    Shard &s = shardFor(key);
+    {
+        std::shared_lock<std::shared_mutex> lock(s.mutex);
+
+        if (!isExpired(s, key))
+        {
+            auto it = s.hash_store.find(key);
+            if (it == s.hash_store.end())
+                return {};
+
+            std::unordered_map<std::string, std::string> out;
+            out.reserve(it->second.size());
+            it->second.forEach([&](std::string_view f, std::string_view v)
+                               { out.emplace(std::string(f), std::string(v)); });
+            return out;
+        }
+    }
+
+    lazyExpire(s, key);
+    return {};
+}
 
-    if (checkExpired(key))
-        return {};
+void RedisDatabase::hgetall(std::string_view key,
+                            const std::function<void(std::string_view, std::string_view)> &visit)
+{
+    Shard &s = shardFor(key);
+    {
+        std::shared_lock<std::shared_mutex> lock(s.mutex);
 
-    auto it = hash_store.find(key);
-    if (it == hash_store.end())
-        return {};
+        if (!isExpired(s, key))
+        {
+            auto it = s.hash_store.find(key);
+            if (it != s.hash_store.end())
+                it->second.forEach(visit);
+            return;
+        }
+    }
 
-    return it->second;
+    lazyExpire(s, key);
 }
 
-std::vector<std::string> RedisDatabase::hkeys(const std::string &key)
+std::vector<std::string> RedisDatabase::hkeys(std::string_view key)
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
+    Shard &s = shardFor(key);
+    {
+        std::shared_lock<std::shared_mutex> lock(s.mutex);
 
-    if (checkExpired(key))
-        return {};
+        if (!isExpired(s, key))
+        {
+            auto it = s.hash_store.find(key);
+            if (it == s.hash_store.end())
+                return {};
 
-    auto it = hash_store.find(key);
-    if (it == hash_store.end())
-        return {};
+            std::vector<std::string> out;
+            out.reserve(it->second.size());
+            it->second.forEach([&](std::string_view f, std::string_view)
+                               { out.emplace_back(f); });
 
-    std::vector<std::string> out;
-    out.reserve(it->second.size());
-    for (auto &p : it->second)
-        out.push_back(p.first);
+            return out;
+        }
+    }
 
-    return out;
+    lazyExpire(s, key);
+    return {};
 }
 
-std::vector<std::string> RedisDatabase::hvals(const std::string &key)
+std::vector<std::string> RedisDatabase::hvals(std::string_view key)
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
+    Shard &s = shardFor(key);
+    {
+        std::shared_lock<std::shared_mutex> lock(s.mutex);
 
-    if (checkExpired(key))
-        return {};
+        if (!isExpired(s, key))
+        {
+            auto it = s.hash_store.find(key);
+            if (it == s.hash_store.end())
+                return {};
 
-    auto it = hash_store.find(key);
-    if (it == hash_store.end())
-        return {};
+            std::vector<std::string> out;
+            out.reserve(it->second.size());
+            it->second.forEach([&](std::string_view, std::string_view v)
+                               { out.emplace_back(v); });
 
-    std::vector<std::string> out;
-    out.reserve(it->second.size());
-    for (auto &p : it->second)
-        out.push_back(p.second);
+            return out;
+        }
+    }
 
-    return out;
+    lazyExpire(s, key);
+    return {};
 }
 
-ssize_t RedisDatabase::hlen(const std::string &key)
+ssize_t RedisDatabase::hlen(std::string_view key)
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
+    Shard &s = shardFor(key);
+    {
+        std::shared_lock<std::shared_mutex> lock(s.mutex);
 
-    if (checkExpired(key))
-        return 0;
+        if (!isExpired(s, key))
+        {
+            auto it = s.hash_store.find(key);
+            return (it == s.hash_store.end()) ? 0 : it->second.size();
+        }
+    }
 
-    auto it = hash_store.find(key);
-    return (it == hash_store.end()) ? 0 : it->second.size();
+    lazyExpire(s, key);
+    return 0;
 }
 
 bool RedisDatabase::hmset(
-    const std::string &key,
+    std::string_view key,
     const std::vector<std::pair<std::string, std::string>> &fv)
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
+    Shard &s = shardFor(key);
+    std::lock_guard<std::shared_mutex> lock(s.mutex);
 
-    if (checkExpired(key))
-    {
-        for (auto &p : fv)
-            hash_store[key][p.first] = p.second;
-        return true;
-    }
+    checkExpired(s, key);
+
+    auto it = s.hash_store.find(key);
+    size_t before = (it != s.hash_store.end()) ? entryUsage(key, it->second) : 0;
+    if (it == s.hash_store.end())
+        it = s.hash_store.emplace(std::string(key), CompactHash{}).first;
 
-    auto &mp = hash_store[key];
     for (auto &p : fv)
-        mp[p.first] = p.second;
+        it->second.set(p.first, p.second);
+    chargeMem(s.mem_used, entryUsage(key, it->second), before);
 
+    touchLru(s, key);
+    evictIfNeeded(s);
     return true;
 }
 
 /* -----------------------------------------------------------------------------
    INCR (improved)
 ----------------------------------------------------------------------------- */
-bool RedisDatabase::incr(const std::string &key, long long &out)
+bool RedisDatabase::incr(std::string_view key, long long &out)
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
+    Shard &s = shardFor(key);
+    std::lock_guard<std::shared_mutex> lock(s.mutex);
 
-    checkExpired(key);
+    checkExpired(s, key);
 
-    auto it = kv_store.find(key);
-    if (it == kv_store.end())
+    auto it = s.kv_store.find(key);
+    if (it == s.kv_store.end())
     {
-        kv_store[key] = "1";
+        auto &v = s.kv_store.emplace(std::string(key), KvValue("1")).first->second;
+        s.mem_used.fetch_add(entryUsage(key, v), std::memory_order_relaxed);
+        if (s.neg_filter)
+            negFilterAdd(s.neg_filter.get(), key);
         out = 1;
+        touchLru(s, key);
+        evictIfNeeded(s);
         return true;
     }
 
-    std::string s = it->second;
-
-    // trim whitespace (Redis-compatible)
-    auto trim = [](std::string &str)
-    {
-        str.erase(0, str.find_first_not_of(" \t\r\n"));
-        str.erase(str.find_last_not_of(" \t\r\n") + 1);
-    };
-    trim(s);
-
-    try
-    {
-        long long v = std::stoll(s);
-        v += 1;
-        it->second = std::to_string(v);
-        out = v;
-        return true;
-    }
-    catch (...)
-    {
-        return false;
-    }
+    // Integer-encoded values increment in place (no parse, no reformat);
+    // a still-string numeric value converts on first INCR (shrinking its
+    // memory charge to the inline integer).
+    size_t before = it->second.memUsage();
+    bool ok = it->second.tryIncr(out);
+    chargeMem(s.mem_used, it->second.memUsage(), before);
+    if (ok)
+        touchLru(s, key);
+    return ok;
 }
 
-long long RedisDatabase::incr(const std::string &key)
+long long RedisDatabase::incr(std::string_view key)
 {
     long long out = 0;
     if (!incr(key, out))
@@ -654,86 +1580,667 @@ long long RedisDatabase::incr(const std::string &key)
 }
 
 /* -----------------------------------------------------------------------------
-   Persistence (unchanged format)
+   Persistence — binary snapshot format (v2)
+
+   Layout (all integers little-endian, host byte order on our platforms):
+
+     magic    "FKVB" (4 bytes)
+     version  u32
+     counts   u64 x4   total kv / list / hash / expiry entries
+     segments SHARD_COUNT record streams, one per shard, back to back
+     records  u8 type, then length-prefixed payload:
+       'K'  u32 klen, key, u32 vlen, val
+       'L'  u32 klen, key, u32 count, count x (u32 len, bytes)
+       'H'  u32 klen, key, u32 pairs, pairs x (u32 flen, f, u32 vlen, v)
+       'E'  u32 klen, key, i64 ms-since-epoch
+     directory u32 nsegs, then per segment 7 x u64:
+              offset, length, FNV-1a checksum of the segment bytes,
+              kv / list / hash / expiry entry counts (for reserve())
+     footer   u64 FNV-1a checksum of the directory, u64 directory offset
+
+   A segment holds exactly the records of one shard, so loading is
+   embarrassingly parallel: N worker threads each checksum and parse
+   whole segments straight into their shards, nothing shared but the
+   file mapping. The v1 format (one record stream, whole-file trailer
+   checksum) is still read, as is the old line-oriented text format.
 ----------------------------------------------------------------------------- */
-bool RedisDatabase::dump(const std::string &filename)
+static constexpr char FKV_MAGIC[4] = {'F', 'K', 'V', 'B'};
+static constexpr uint32_t FKV_VERSION = 2;
+
+namespace
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
+    constexpr uint64_t FNV_OFFSET = 14695981039346656037ULL;
+    constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+    inline void fnv1a(uint64_t &h, const void *data, size_t n)
+    {
+        const unsigned char *p = (const unsigned char *)data;
+        for (size_t i = 0; i < n; i++)
+        {
+            h ^= p[i];
+            h *= FNV_PRIME;
+        }
+    }
+
+    // Checksumming writer: every byte that goes to the stream also goes
+    // through the running FNV hash; the hash is reset at each segment
+    // boundary so the directory records one checksum per segment. off
+    // counts bytes written (= stream position) for the offset fields.
+    struct BinWriter
+    {
+        std::ofstream &ofs;
+        uint64_t hash = FNV_OFFSET;
+        uint64_t off = 0;
+
+        void raw(const void *data, size_t n)
+        {
+            ofs.write((const char *)data, n);
+            fnv1a(hash, data, n);
+            off += n;
+        }
+
+        void u8(uint8_t v) { raw(&v, 1); }
+        void u32(uint32_t v) { raw(&v, 4); }
+        void u64(uint64_t v) { raw(&v, 8); }
+        void i64(int64_t v) { raw(&v, 8); }
+
+        void str(std::string_view v)
+        {
+            u32((uint32_t)v.size());
+            raw(v.data(), v.size());
+        }
+    };
+
+    // Bounds-checked sequential reader over the mapped snapshot
+    struct BinReader
+    {
+        const char *p;
+        const char *end;
+        bool ok = true;
+
+        bool need(size_t n)
+        {
+            if ((size_t)(end - p) < n)
+            {
+                ok = false;
+                return false;
+            }
+            return true;
+        }
+
+        uint8_t u8()
+        {
+            if (!need(1))
+                return 0;
+            return (uint8_t)*p++;
+        }
+
+        uint32_t u32()
+        {
+            if (!need(4))
+                return 0;
+            uint32_t v;
+            std::memcpy(&v, p, 4);
+            p += 4;
+            return v;
+        }
+
+        int64_t i64()
+        {
+            if (!need(8))
+                return 0;
+            int64_t v;
+            std::memcpy(&v, p, 8);
+            p += 8;
+            return v;
+        }
+
+        std::string_view str()
+        {
+            uint32_t n = u32();
+            if (!need(n))
+                return {};
+            std::string_view v(p, n);
+            p += n;
+            return v;
+        }
+    };
+}
 
+bool RedisDatabase::dump(const std::string &filename)
+{
     std::ofstream ofs(filename, std::ios::binary | std::ios::trunc);
     if (!ofs)
         return false;
 
-    // Strings
-    for (auto &kv : kv_store)
+    BinWriter w{ofs};
+
+    // Header: magic, version, totals (totals are a consistent-enough
+    // pre-sizing hint; they are gathered shard by shard like the records)
+    uint64_t kv_count = 0, list_count = 0, hash_count = 0, expiry_count = 0;
+    for (auto &s : shards)
     {
-        ofs.put('K');
-        ofs << ' ' << kv.first.size() << ' ' << kv.second.size() << '\n';
-        ofs.write(kv.first.data(), kv.first.size());
-        ofs.write(kv.second.data(), kv.second.size());
-        ofs.put('\n');
+        std::shared_lock<std::shared_mutex> lock(s.mutex);
+        kv_count += s.kv_store.size();
+        list_count += s.list_store.size();
+        hash_count += s.hash_store.size();
+        expiry_count += s.expiry_map.size();
     }
 
-    // Lists
-    for (auto &kv : list_store)
+    w.raw(FKV_MAGIC, 4);
+    w.u32(FKV_VERSION);
+    w.u64(kv_count);
+    w.u64(list_count);
+    w.u64(hash_count);
+    w.u64(expiry_count);
+
+    // offset, length, checksum, then per-type entry counts
+    struct SegMeta
     {
-        ofs.put('L');
-        ofs << ' ' << kv.first.size() << ' ' << kv.second.size() << '\n';
-        ofs.write(kv.first.data(), kv.first.size());
+        uint64_t off, len, hash, kv, list, hashes, expiries;
+    };
+    SegMeta meta[SHARD_COUNT];
+    size_t seg = 0;
+
+    for (auto &s : shards)
+    {
+        // Serialization only reads, so a shared lock is enough: a dump in
+        // progress never stalls the read hot path on that shard.
+        std::shared_lock<std::shared_mutex> lock(s.mutex);
+
+        SegMeta &m = meta[seg++];
+        m.off = w.off;
+        m.kv = s.kv_store.size();
+        m.list = s.list_store.size();
+        m.hashes = s.hash_store.size();
+        m.expiries = s.expiry_map.size();
+        w.hash = FNV_OFFSET; // per-segment checksum stream
+
+        for (auto &kv : s.kv_store)
+        {
+            w.u8('K');
+            w.str(kv.first);
+            w.str(kv.second.toString());
+        }
+
+        for (auto &kv : s.list_store)
+        {
+            w.u8('L');
+            w.str(kv.first);
+            w.u32((uint32_t)kv.second.size());
+            kv.second.forEach([&](std::string_view item)
+                              { w.str(item); });
+        }
 
-        for (auto &item : kv.second)
+        for (auto &kv : s.hash_store)
         {
-            ofs << ' ' << item.size() << '\n';
-            ofs.write(item.data(), item.size());
+            w.u8('H');
+            w.str(kv.first);
+            w.u32((uint32_t)kv.second.size());
+            kv.second.forEach([&](std::string_view f, std::string_view v)
+                              {
+                                  w.str(f);
+                                  w.str(v);
+                              });
         }
-        ofs.put('\n');
+
+        for (auto &e : s.expiry_map)
+        {
+            long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                               e.second.time_since_epoch())
+                               .count();
+            w.u8('E');
+            w.str(e.first);
+            w.i64(ms);
+        }
+
+        m.len = w.off - m.off;
+        m.hash = w.hash;
+    }
+
+    // Directory + footer: segment table, its checksum, and where it starts
+    uint64_t dir_off = w.off;
+    w.hash = FNV_OFFSET;
+    w.u32(SHARD_COUNT);
+    for (auto &m : meta)
+    {
+        w.u64(m.off);
+        w.u64(m.len);
+        w.u64(m.hash);
+        w.u64(m.kv);
+        w.u64(m.list);
+        w.u64(m.hashes);
+        w.u64(m.expiries);
+    }
+
+    uint64_t dir_hash = w.hash;
+    ofs.write((const char *)&dir_hash, 8);
+    ofs.write((const char *)&dir_off, 8);
+
+    ofs.flush();
+    return ofs.good();
+}
+
+bool RedisDatabase::load(const std::string &filename)
+{
+    // Sniff the magic to pick the right loader
+    char magic[4] = {0};
+    {
+        std::ifstream ifs(filename, std::ios::binary);
+        if (!ifs)
+            return false;
+        ifs.read(magic, 4);
+    }
+
+    if (std::memcmp(magic, FKV_MAGIC, 4) == 0)
+        return loadBinary(filename);
+
+    return loadText(filename);
+}
+
+bool RedisDatabase::loadBinary(const std::string &filename)
+{
+    const char *base = nullptr;
+    size_t size = 0;
+
+#ifndef _WIN32
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || st.st_size < 0)
+    {
+        ::close(fd);
+        return false;
     }
+    size = (size_t)st.st_size;
+
+    void *map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED)
+        return false;
+    base = (const char *)map;
+#else
+    // No mmap on Windows builds: read the file in one shot instead
+    std::ifstream ifs(filename, std::ios::binary | std::ios::ate);
+    if (!ifs)
+        return false;
+    size = (size_t)ifs.tellg();
+    std::string contents(size, '\0');
+    ifs.seekg(0);
+    ifs.read(&contents[0], size);
+    base = contents.data();
+#endif
+
+    bool ok = false;
+
+    // Dispatch on the version field (after the 4-byte magic)
+    uint32_t version = 0;
+    if (size >= 8)
+        std::memcpy(&version, base + 4, 4);
+
+    if (version == 1)
+        ok = loadBinaryV1(base, size, filename);
+    else if (version == FKV_VERSION)
+        ok = loadBinaryV2(base, size, filename);
+    else
+        Logger::getInstance().error("Unsupported snapshot version " + std::to_string(version));
+
+#ifndef _WIN32
+    munmap((void *)base, size);
+#endif
+
+    if (ok)
+        purgeExpired();
+    return ok;
+}
 
-    // Hashes
-    for (auto &kv : hash_store)
+/* v1: one record stream, whole-file trailer checksum, sequential build */
+bool RedisDatabase::loadBinaryV1(const char *base, size_t size, const std::string &filename)
+{
+    bool ok = false;
+
+    do
     {
-        ofs.put('H');
-        ofs << ' ' << kv.first.size() << ' ' << kv.second.size() << '\n';
-        ofs.write(kv.first.data(), kv.first.size());
+        // magic(4) + version(4) + counts(32) + trailer(8)
+        if (size < 48)
+            break;
+
+        // Verify trailer checksum over everything before it
+        uint64_t stored = 0;
+        std::memcpy(&stored, base + size - 8, 8);
+        uint64_t computed = FNV_OFFSET;
+        fnv1a(computed, base, size - 8);
+        if (stored != computed)
+        {
+            Logger::getInstance().error("Snapshot checksum mismatch: " + filename);
+            break;
+        }
+
+        BinReader r{base + 8, base + size - 8};
+
+        uint64_t kv_count = r.i64();
+        uint64_t list_count = r.i64();
+        uint64_t hash_count = r.i64();
+        uint64_t expiry_count = r.i64();
+
+        flushAll();
+
+        // Pre-size the target maps so the build pass never rehashes
+        for (auto &s : shards)
+        {
+            std::lock_guard<std::shared_mutex> lock(s.mutex);
+            s.kv_store.reserve(kv_count / SHARD_COUNT + 1);
+            s.list_store.reserve(list_count / SHARD_COUNT + 1);
+            s.hash_store.reserve(hash_count / SHARD_COUNT + 1);
+            s.expiry_map.reserve(expiry_count / SHARD_COUNT + 1);
+        }
+
+        ok = true;
+        while (r.ok && r.p < r.end)
+        {
+            uint8_t type = r.u8();
+
+            if (type == 'K')
+            {
+                std::string_view key = r.str();
+                std::string_view val = r.str();
+                if (!r.ok)
+                    break;
+
+                Shard &s = shardFor(key);
+                std::lock_guard<std::shared_mutex> lock(s.mutex);
+                auto &v = s.kv_store.emplace(std::string(key), KvValue(val)).first->second;
+                s.mem_used.fetch_add(entryUsage(key, v), std::memory_order_relaxed);
+                if (s.neg_filter)
+                    negFilterAdd(s.neg_filter.get(), key);
+            }
+            else if (type == 'L')
+            {
+                std::string_view key = r.str();
+                uint32_t count = r.u32();
+
+                std::deque<std::string> dq;
+                for (uint32_t i = 0; i < count && r.ok; i++)
+                    dq.emplace_back(r.str());
+                if (!r.ok)
+                    break;
+
+                CompactList lst;
+                lst.assignFrom(std::move(dq));
+
+                Shard &s = shardFor(key);
+                std::lock_guard<std::shared_mutex> lock(s.mutex);
+                s.mem_used.fetch_add(entryUsage(key, lst), std::memory_order_relaxed);
+                s.list_store.emplace(std::string(key), std::move(lst));
+            }
+            else if (type == 'H')
+            {
+                std::string_view key = r.str();
+                uint32_t pairs = r.u32();
+
+                CompactHash mp;
+                for (uint32_t i = 0; i < pairs && r.ok; i++)
+                {
+                    std::string_view f = r.str();
+                    std::string_view v = r.str();
+                    mp.set(f, v);
+                }
+                if (!r.ok)
+                    break;
+
+                Shard &s = shardFor(key);
+                std::lock_guard<std::shared_mutex> lock(s.mutex);
+                s.mem_used.fetch_add(entryUsage(key, mp), std::memory_order_relaxed);
+                s.hash_store.emplace(std::string(key), std::move(mp));
+            }
+            else if (type == 'E')
+            {
+                std::string_view key = r.str();
+                long long ms = r.i64();
+                if (!r.ok)
+                    break;
+
+                Shard &s = shardFor(key);
+                std::lock_guard<std::shared_mutex> lock(s.mutex);
+                setExpiry_locked(s, key, tp_from_ms_since_epoch(ms));
+            }
+            else
+            {
+                Logger::getInstance().error("Corrupt snapshot record type " + std::to_string(type));
+                ok = false;
+                break;
+            }
+        }
 
-        for (auto &p : kv.second)
+        if (!r.ok)
         {
-            ofs << ' ' << p.first.size() << ' ' << p.second.size() << '\n';
-            ofs.write(p.first.data(), p.first.size());
-            ofs.write(p.second.data(), p.second.size());
+            Logger::getInstance().error("Truncated snapshot: " + filename);
+            ok = false;
         }
-        ofs.put('\n');
+    } while (false);
+
+    return ok;
+}
+
+/* v2: per-shard segments checksummed and parsed by N worker threads.
+   Each worker owns whole segments, so it locks its shard once, reserves
+   from the directory's exact per-segment counts, and inserts with no
+   cross-thread contention at all. */
+bool RedisDatabase::loadBinaryV2(const char *base, size_t size, const std::string &filename)
+{
+    // magic(4) + version(4) + counts(32) + dir(u32) + footer(16)
+    if (size < 60)
+        return false;
+
+    // Footer: directory offset, then verify the directory checksum
+    // Segments start right after the 40-byte header
+    uint64_t dir_off = 0;
+    std::memcpy(&dir_off, base + size - 8, 8);
+    if (dir_off < 40 || dir_off > size - 16)
+    {
+        Logger::getInstance().error("Corrupt snapshot directory offset: " + filename);
+        return false;
+    }
+
+    uint64_t dir_stored = 0;
+    std::memcpy(&dir_stored, base + size - 16, 8);
+    uint64_t dir_computed = FNV_OFFSET;
+    fnv1a(dir_computed, base + dir_off, size - 16 - dir_off);
+    if (dir_stored != dir_computed)
+    {
+        Logger::getInstance().error("Snapshot directory checksum mismatch: " + filename);
+        return false;
     }
 
-    // Expiries
-    for (auto &e : expiry_map)
+    BinReader d{base + dir_off, base + size - 16};
+    uint32_t nsegs = d.u32();
+    if (nsegs != SHARD_COUNT)
     {
-        long long ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-                           e.second.time_since_epoch())
-                           .count();
+        // The segment<->shard mapping is 1:1 by construction; a different
+        // shard count means a different engine build wrote this file.
+        Logger::getInstance().error("Snapshot shard count mismatch (" +
+                                    std::to_string(nsegs) + " segments): " + filename);
+        return false;
+    }
+
+    struct SegMeta
+    {
+        uint64_t off, len, hash, kv, list, hashes, expiries;
+    };
+    SegMeta meta[SHARD_COUNT];
 
-        ofs.put('E');
-        ofs << ' ' << e.first.size() << ' ' << ms << '\n';
-        ofs.write(e.first.data(), e.first.size());
-        ofs.put('\n');
+    for (auto &m : meta)
+    {
+        m.off = d.i64();
+        m.len = d.i64();
+        m.hash = d.i64();
+        m.kv = d.i64();
+        m.list = d.i64();
+        m.hashes = d.i64();
+        m.expiries = d.i64();
+
+        if (!d.ok || m.off < 40 || m.len > dir_off || m.off + m.len > dir_off)
+        {
+            Logger::getInstance().error("Corrupt snapshot directory: " + filename);
+            return false;
+        }
     }
 
-    ofs.flush();
+    flushAll();
+
+    unsigned hw = std::thread::hardware_concurrency();
+    size_t nthreads = std::min<size_t>(hw ? hw : 1, SHARD_COUNT);
+
+    std::atomic<bool> all_ok{true};
+
+    auto loadSegment = [&](size_t i)
+    {
+        const SegMeta &m = meta[i];
+
+        uint64_t computed = FNV_OFFSET;
+        fnv1a(computed, base + m.off, m.len);
+        if (computed != m.hash)
+        {
+            Logger::getInstance().error("Snapshot segment " + std::to_string(i) +
+                                        " checksum mismatch: " + filename);
+            return false;
+        }
+
+        Shard &s = shards[i];
+        std::lock_guard<std::shared_mutex> lock(s.mutex);
+
+        s.kv_store.reserve(m.kv);
+        s.list_store.reserve(m.list);
+        s.hash_store.reserve(m.hashes);
+        s.expiry_map.reserve(m.expiries);
+
+        BinReader r{base + m.off, base + m.off + m.len};
+
+        while (r.ok && r.p < r.end)
+        {
+            uint8_t type = r.u8();
+
+            if (type == 'K')
+            {
+                std::string_view key = r.str();
+                std::string_view val = r.str();
+                if (!r.ok)
+                    break;
+                if (&shardFor(key) != &s)
+                {
+                    r.ok = false;
+                    break;
+                }
+
+                auto &v = s.kv_store.emplace(std::string(key), KvValue(val)).first->second;
+                s.mem_used.fetch_add(entryUsage(key, v), std::memory_order_relaxed);
+                if (s.neg_filter)
+                    negFilterAdd(s.neg_filter.get(), key);
+            }
+            else if (type == 'L')
+            {
+                std::string_view key = r.str();
+                uint32_t count = r.u32();
+
+                std::deque<std::string> dq;
+                for (uint32_t j = 0; j < count && r.ok; j++)
+                    dq.emplace_back(r.str());
+                if (!r.ok)
+                    break;
+                if (&shardFor(key) != &s)
+                {
+                    r.ok = false;
+                    break;
+                }
+
+                CompactList lst;
+                lst.assignFrom(std::move(dq));
+                s.mem_used.fetch_add(entryUsage(key, lst), std::memory_order_relaxed);
+                s.list_store.emplace(std::string(key), std::move(lst));
+            }
+            else if (type == 'H')
+            {
+                std::string_view key = r.str();
+                uint32_t pairs = r.u32();
+
+                CompactHash mp;
+                for (uint32_t j = 0; j < pairs && r.ok; j++)
+                {
+                    std::string_view f = r.str();
+                    std::string_view v = r.str();
+                    mp.set(f, v);
+                }
+                if (!r.ok)
+                    break;
+                if (&shardFor(key) != &s)
+                {
+                    r.ok = false;
+                    break;
+                }
+
+                s.mem_used.fetch_add(entryUsage(key, mp), std::memory_order_relaxed);
+                s.hash_store.emplace(std::string(key), std::move(mp));
+            }
+            else if (type == 'E')
+            {
+                std::string_view key = r.str();
+                long long ms = r.i64();
+                if (!r.ok)
+                    break;
+                if (&shardFor(key) != &s)
+                {
+                    r.ok = false;
+                    break;
+                }
+
+                setExpiry_locked(s, key, tp_from_ms_since_epoch(ms));
+            }
+            else
+            {
+                r.ok = false;
+                break;
+            }
+        }
+
+        // Checksummed bytes that still fail to parse (or route to the
+        // wrong shard) mean a writer bug, not bit rot — report as corrupt
+        if (!r.ok || r.p != r.end)
+        {
+            Logger::getInstance().error("Corrupt snapshot segment " + std::to_string(i) +
+                                        ": " + filename);
+            return false;
+        }
+        return true;
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < nthreads; t++)
+        workers.emplace_back([&, t]()
+                             {
+            for (size_t i = t; i < SHARD_COUNT; i += nthreads)
+                if (!loadSegment(i))
+                    all_ok.store(false, std::memory_order_relaxed); });
+
+    for (auto &w : workers)
+        w.join();
+
+    if (!all_ok.load(std::memory_order_relaxed))
+    {
+        flushAll(); // never serve a half-loaded dataset
+        return false;
+    }
     return true;
 }
 
-bool RedisDatabase::load(const std::string &filename)
+bool RedisDatabase::loadText(const std::string &filename)
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
-
     std::ifstream ifs(filename, std::ios::binary);
     if (!ifs)
         return false;
 
-    kv_store.clear();
-    list_store.clear();
-    hash_store.clear();
-    expiry_map.clear();
+    flushAll();
 
     while (ifs.peek() != EOF)
     {
@@ -755,7 +2262,14 @@ bool RedisDatabase::load(const std::string &filename)
             if (ifs.peek() == '\n')
                 ifs.get();
 
-            kv_store[std::move(key)] = std::move(val);
+            Shard &s = shardFor(key);
+            std::lock_guard<std::shared_mutex> lock(s.mutex);
+            size_t klen = key.size();
+            if (s.neg_filter)
+                negFilterAdd(s.neg_filter.get(), key);
+            auto &v = s.kv_store[std::move(key)];
+            v.assign(val);
+            s.mem_used.fetch_add(KEY_OVERHEAD + klen + v.memUsage(), std::memory_order_relaxed);
         }
         else if (type == 'L')
         {
@@ -781,7 +2295,14 @@ bool RedisDatabase::load(const std::string &filename)
 
             if (ifs.peek() == '\n')
                 ifs.get();
-            list_store[std::move(key)] = std::move(dq);
+
+            CompactList lst;
+            lst.assignFrom(std::move(dq));
+
+            Shard &s = shardFor(key);
+            std::lock_guard<std::shared_mutex> lock(s.mutex);
+            s.mem_used.fetch_add(entryUsage(key, lst), std::memory_order_relaxed);
+            s.list_store[std::move(key)] = std::move(lst);
         }
         else if (type == 'H')
         {
@@ -792,7 +2313,7 @@ bool RedisDatabase::load(const std::string &filename)
             std::string key(key_len, '\0');
             ifs.read(&key[0], key_len);
 
-            std::unordered_map<std::string, std::string> mp;
+            CompactHash mp;
 
             for (size_t i = 0; i < pairs; i++)
             {
@@ -805,12 +2326,16 @@ bool RedisDatabase::load(const std::string &filename)
                 ifs.read(&field[0], fl);
                 ifs.read(&val[0], vl);
 
-                mp.emplace(std::move(field), std::move(val));
+                mp.set(field, val);
             }
 
             if (ifs.peek() == '\n')
                 ifs.get();
-            hash_store[std::move(key)] = std::move(mp);
+
+            Shard &s = shardFor(key);
+            std::lock_guard<std::shared_mutex> lock(s.mutex);
+            s.mem_used.fetch_add(entryUsage(key, mp), std::memory_order_relaxed);
+            s.hash_store[std::move(key)] = std::move(mp);
         }
         else if (type == 'E')
         {
@@ -824,7 +2349,10 @@ bool RedisDatabase::load(const std::string &filename)
 
             if (ifs.peek() == '\n')
                 ifs.get();
-            expiry_map[std::move(key)] = tp_from_ms_since_epoch(ms);
+
+            Shard &s = shardFor(key);
+            std::lock_guard<std::shared_mutex> lock(s.mutex);
+            setExpiry_locked(s, key, tp_from_ms_since_epoch(ms));
         }
         else
         {
@@ -833,12 +2361,87 @@ bool RedisDatabase::load(const std::string &filename)
         }
     }
 
-    purgeExpired_locked();
+    purgeExpired();
+    return true;
+}
+
+/* -----------------------------------------------------------------------------
+   BGSAVE: snapshot without blocking the serving path.
+
+   POSIX: all shard locks are taken around fork() so the child never inherits
+   a mutex held by a thread that does not exist after fork; the child then
+   serializes its copy-on-write view and _exit()s, while the parent releases
+   the locks immediately. Elsewhere (or if fork fails) a detached thread runs
+   the ordinary shard-at-a-time dump, which only briefly locks each shard.
+   Both paths write to <filename>.tmp and rename into place on success.
+----------------------------------------------------------------------------- */
+bool RedisDatabase::bgsave(const std::string &filename)
+{
+    bool expected = false;
+    if (!bgsave_running.compare_exchange_strong(expected, true))
+        return false;
+
+    std::string tmp = filename + ".tmp";
+
+#ifndef _WIN32
+    for (auto &s : shards)
+        s.mutex.lock();
+
+    pid_t pid = fork();
+
+    if (pid == 0)
+    {
+        // Child: sole thread, owns every shard lock it inherited
+        for (auto &s : shards)
+            s.mutex.unlock();
+
+        bool ok = dump(tmp) && std::rename(tmp.c_str(), filename.c_str()) == 0;
+        _exit(ok ? 0 : 1);
+    }
+
+    for (auto &s : shards)
+        s.mutex.unlock();
+
+    if (pid > 0)
+    {
+        std::thread([this, pid, filename]()
+                    {
+            int status = 0;
+            waitpid(pid, &status, 0);
+
+            if (WIFEXITED(status) && WEXITSTATUS(status) == 0)
+                Logger::getInstance().info("Background save completed: " + filename);
+            else
+                Logger::getInstance().error("Background save child failed: " + filename);
+
+            bgsave_running.store(false, std::memory_order_release); })
+            .detach();
+        return true;
+    }
+
+    Logger::getInstance().warn("fork failed errno=" + std::to_string(errno) +
+                               ", falling back to snapshot thread");
+#endif
+
+    std::thread([this, filename, tmp]()
+                {
+        bool ok = dump(tmp) && std::rename(tmp.c_str(), filename.c_str()) == 0;
+
+        if (ok)
+            Logger::getInstance().info("Background save completed: " + filename);
+        else
+            Logger::getInstance().error("Background save failed: " + filename);
+
+        bgsave_running.store(false, std::memory_order_release); })
+        .detach();
     return true;
 }
 
 void RedisDatabase::purgeExpired()
 {
-    std::lock_guard<std::mutex> lock(db_mutex);
-    purgeExpired_locked();
+    for (auto &s : shards)
+    {
+        std::lock_guard<std::shared_mutex> lock(s.mutex);
+        purgeExpired_locked(s);
+    }
 }
@@ -4,6 +4,7 @@
 #include "../include/RedisCommandHandler.h"
 #include "../include/RedisDatabase.h"
 #include "../include/Logger.h"
+#include "../include/ServerStats.h"
 
 #include <iostream>
 #include <thread>
@@ -14,6 +15,7 @@
 #include <sstream>
 #include <iomanip>
 #include <cerrno>
+#include <climits>
 
 #ifdef _WIN32
 #include <winsock2.h>
@@ -23,15 +25,38 @@
 using socket_errno_t = int;
 #else
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <unistd.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
 #include <signal.h>
 #include <netinet/tcp.h>
+#include <fcntl.h>
 #define CLOSE_SOCKET close
 using socket_errno_t = int;
 #endif
 
+#if defined(__linux__)
+#define HAVE_EPOLL 1
+#include <sys/epoll.h>
+#elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__)
+#define HAVE_KQUEUE 1
+#include <sys/event.h>
+#endif
+
+// io_uring straight from the kernel UAPI header — no liburing dependency,
+// same spirit as using epoll/kqueue directly above. Whether the running
+// kernel actually supports it is probed at startup (runUringLoop).
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define HAVE_IO_URING 1
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#endif
+
+#include <unordered_map>
+
 /* ============================================================
    GLOBAL POINTER FOR SIGNAL HANDLER
    ============================================================ */
@@ -79,12 +104,22 @@ void RedisServer::setupSignalHandler()
 /* ============================================================
    CONSTRUCTOR (MERGED)
    ============================================================ */
-RedisServer::RedisServer(int port)
+RedisServer::RedisServer(int port, IoMode mode, int acceptors, int backlog,
+                         const std::string &unixsocket)
     : port(port),
       server_socket(INVALID_SOCKET_T),
       running(true),
+      io_mode(mode),
+      num_acceptors(acceptors < 1 ? 1 : acceptors),
+      listen_backlog(backlog < 1 ? 128 : backlog),
+      unix_path(unixsocket),
       thread_pool(std::make_unique<ThreadPool>(std::thread::hardware_concurrency()))
 {
+#if !defined(HAVE_EPOLL) && !defined(HAVE_KQUEUE)
+    // No poller on this platform: thread-per-connection is the only option
+    io_mode = IoMode::Threads;
+#endif
+
     globalServer = this;
     setupSignalHandler();
 
@@ -109,11 +144,18 @@ void RedisServer::shutdown()
 {
     running.store(false, std::memory_order_release);
 
+    // server_socket is listen_sockets[0] when run() got that far
+    for (socket_t fd : listen_sockets)
+        CLOSE_SOCKET(fd);
+    listen_sockets.clear();
+
+#ifndef _WIN32
+    if (!unix_path.empty())
+        ::unlink(unix_path.c_str());
+#endif
+
     if (server_socket != INVALID_SOCKET_T)
-    {
-        CLOSE_SOCKET(server_socket);
         server_socket = INVALID_SOCKET_T;
-    }
 
     if (thread_pool)
     {
@@ -127,37 +169,35 @@ void RedisServer::shutdown()
 }
 
 /* ============================================================
-   MAIN SERVER LOOP (MERGED WITH THREADPOOL)
+   LISTENER FACTORY
+
+   One bound+listening socket. SO_REUSEPORT (when requested and
+   supported) lets several such sockets share the port, with the
+   kernel load-balancing incoming connections across them — each
+   acceptor then drains its own private backlog instead of all
+   of them contending on one.
    ============================================================ */
-void RedisServer::run()
+socket_t RedisServer::createListener(bool want_reuseport, bool &reuseport_ok)
 {
-#ifdef _WIN32
-    WSADATA wsa;
-    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0)
-    {
-        Logger::getInstance().error("WSAStartup failed");
-        return;
-    }
-#endif
+    reuseport_ok = false;
 
-    /* ------------------------------
-       Create Socket
-       ------------------------------ */
-    server_socket = socket(AF_INET, SOCK_STREAM, 0);
-    if (server_socket == INVALID_SOCKET_T)
+    socket_t fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd == INVALID_SOCKET_T)
     {
         Logger::getInstance().error("Socket creation failed");
-#ifdef _WIN32
-        WSACleanup();
-#endif
-        return;
+        return INVALID_SOCKET_T;
     }
 
     int opt = 1;
 #ifdef _WIN32
-    setsockopt(server_socket, SOL_SOCKET, SO_REUSEADDR, (char *)&opt, sizeof(opt));
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (char *)&opt, sizeof(opt));
+    (void)want_reuseport; // no SO_REUSEPORT load balancing on Windows
 #else
-    setsockopt(server_socket, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+#ifdef SO_REUSEPORT
+    if (want_reuseport)
+        reuseport_ok = setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) == 0;
+#endif
 #endif
 
     sockaddr_in addr{};
@@ -165,35 +205,202 @@ void RedisServer::run()
     addr.sin_port = htons(port);
     addr.sin_addr.s_addr = INADDR_ANY;
 
-    if (bind(server_socket, (sockaddr *)&addr, sizeof(addr)) < 0)
+    if (bind(fd, (sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        Logger::getInstance().error("Bind failed errno=" + std::to_string(errno));
+        CLOSE_SOCKET(fd);
+        return INVALID_SOCKET_T;
+    }
+
+    if (listen(fd, listen_backlog) < 0)
     {
-        Logger::getInstance().error("Bind failed");
-        CLOSE_SOCKET(server_socket);
+        Logger::getInstance().error("Listen failed errno=" + std::to_string(errno));
+        CLOSE_SOCKET(fd);
+        return INVALID_SOCKET_T;
+    }
+
+    return fd;
+}
+
+/* ============================================================
+   UNIX SOCKET LISTENER (POSIX)
+
+   Sidecar clients on the same host skip the TCP loopback stack
+   entirely; the accepted fds flow through the exact same worker
+   paths as TCP connections (the TCP-specific setsockopt calls
+   are harmless no-ops on AF_UNIX).
+   ============================================================ */
+socket_t RedisServer::createUnixListener()
+{
 #ifdef _WIN32
-        WSACleanup();
+    Logger::getInstance().error("--unixsocket is not supported on Windows");
+    return INVALID_SOCKET_T;
+#else
+    sockaddr_un addr{};
+    if (unix_path.size() >= sizeof(addr.sun_path))
+    {
+        Logger::getInstance().error("Unix socket path too long: " + unix_path);
+        return INVALID_SOCKET_T;
+    }
+
+    socket_t fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd == INVALID_SOCKET_T)
+    {
+        Logger::getInstance().error("Unix socket creation failed errno=" + std::to_string(errno));
+        return INVALID_SOCKET_T;
+    }
+
+    // A previous unclean shutdown leaves the path behind; bind would
+    // fail with EADDRINUSE even though nobody is listening.
+    ::unlink(unix_path.c_str());
+
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, unix_path.c_str(), sizeof(addr.sun_path) - 1);
+
+    if (bind(fd, (sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        Logger::getInstance().error("Unix socket bind failed errno=" + std::to_string(errno) +
+                                    " path=" + unix_path);
+        CLOSE_SOCKET(fd);
+        return INVALID_SOCKET_T;
+    }
+
+    if (listen(fd, listen_backlog) < 0)
+    {
+        Logger::getInstance().error("Unix socket listen failed errno=" + std::to_string(errno));
+        CLOSE_SOCKET(fd);
+        return INVALID_SOCKET_T;
+    }
+
+    return fd;
 #endif
+}
+
+/* ============================================================
+   MAIN SERVER LOOP (MERGED WITH THREADPOOL)
+   ============================================================ */
+void RedisServer::run()
+{
+#ifdef _WIN32
+    WSADATA wsa;
+    if (WSAStartup(MAKEWORD(2, 2), &wsa) != 0)
+    {
+        Logger::getInstance().error("WSAStartup failed");
         return;
     }
+#endif
 
-    if (listen(server_socket, 128) < 0)
+    /* ------------------------------
+       Create Listening Socket(s)
+       ------------------------------ */
+    bool reuseport = false;
+    server_socket = createListener(num_acceptors > 1, reuseport);
+    if (server_socket == INVALID_SOCKET_T)
     {
-        Logger::getInstance().error("Listen failed");
-        CLOSE_SOCKET(server_socket);
 #ifdef _WIN32
         WSACleanup();
 #endif
         return;
     }
+    listen_sockets.push_back(server_socket);
+
+    if (num_acceptors > 1)
+    {
+        if (reuseport)
+        {
+            for (int i = 1; i < num_acceptors; i++)
+            {
+                bool ok = false;
+                socket_t fd = createListener(true, ok);
+                if (fd == INVALID_SOCKET_T || !ok)
+                {
+                    if (fd != INVALID_SOCKET_T)
+                        CLOSE_SOCKET(fd);
+                    Logger::getInstance().warn("Could only create " +
+                                               std::to_string(listen_sockets.size()) +
+                                               " of " + std::to_string(num_acceptors) +
+                                               " reuseport listeners");
+                    break;
+                }
+                listen_sockets.push_back(fd);
+            }
+        }
+        else
+        {
+            Logger::getInstance().warn("SO_REUSEPORT unavailable; " +
+                                       std::to_string(num_acceptors) +
+                                       " acceptors share one listening socket");
+        }
+    }
+
+    if (!unix_path.empty())
+    {
+        socket_t ufd = createUnixListener();
+        if (ufd != INVALID_SOCKET_T)
+        {
+            listen_sockets.push_back(ufd);
+            Logger::getInstance().info("Unix socket listening at " + unix_path);
+        }
+    }
 
     std::cout << "Redis Server running on port " << port << "\n";
-    Logger::getInstance().info("Server accepting connections");
+    Logger::getInstance().info("Server accepting connections (" +
+                               std::to_string(num_acceptors) + " acceptors, " +
+                               std::to_string(listen_sockets.size()) + " sockets, backlog " +
+                               std::to_string(listen_backlog) + ")");
 
-    /* ------------------------------
-       ACCEPT LOOP
-       ------------------------------ */
+#if defined(HAVE_EPOLL) || defined(HAVE_KQUEUE)
+    if (io_mode == IoMode::Uring)
+    {
+        if (!runUringLoop())
+        {
+            Logger::getInstance().warn("io_uring unavailable; falling back to event loop");
+            runEventLoop();
+        }
+    }
+    else if (io_mode == IoMode::Events)
+    {
+        runEventLoop();
+    }
+    else
+#endif
+    {
+        // One accept loop per acceptor; with reuseport listeners each loop
+        // drains its own socket, otherwise they all accept on the shared
+        // one (accept() is thread-safe). Loop 0 runs on this thread. Every
+        // listener (including the unix socket) needs at least one loop.
+        int accept_loops = std::max(num_acceptors, (int)listen_sockets.size());
+
+        std::vector<std::thread> extra;
+        for (int i = 1; i < accept_loops; i++)
+        {
+            socket_t lfd = listen_sockets[i % listen_sockets.size()];
+            extra.emplace_back([this, lfd]()
+                               { runAcceptLoop(lfd); });
+        }
+
+        runAcceptLoop(listen_sockets[0]);
+
+        for (auto &t : extra)
+            if (t.joinable())
+                t.join();
+    }
+
+    Logger::getInstance().info("Accept loop exited");
+
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+/* ============================================================
+   ACCEPT LOOP (thread-per-connection fallback)
+   ============================================================ */
+void RedisServer::runAcceptLoop(socket_t listen_fd)
+{
     while (running.load(std::memory_order_acquire))
     {
-        socket_t client_fd = accept(server_socket, nullptr, nullptr);
+        socket_t client_fd = accept(listen_fd, nullptr, nullptr);
 
 #ifdef _WIN32
         if (client_fd == INVALID_SOCKET)
@@ -231,12 +438,6 @@ void RedisServer::run()
             CLOSE_SOCKET(client_fd);
         }
     }
-
-    Logger::getInstance().info("Accept loop exited");
-
-#ifdef _WIN32
-    WSACleanup();
-#endif
 }
 
 /* ============================================================
@@ -245,11 +446,17 @@ void RedisServer::run()
 void RedisServer::handleClient(socket_t client_fd)
 {
     RedisCommandHandler handler;
+    ServerStats::getInstance().connectionOpened();
 
     std::string buffer;
     buffer.reserve(4096);
     const size_t MAX_BUFFER = 4 * 1024 * 1024;
 
+    // Per-connection output buffer: responses for one recv batch are
+    // accumulated here and flushed with a single send.
+    std::string outbuf;
+    outbuf.reserve(4096);
+
     std::vector<char> recvbuf(8192);
 
     /* ------------------------------ TCP_NODELAY ------------------------------ */
@@ -286,7 +493,7 @@ void RedisServer::handleClient(socket_t client_fd)
     }
 #endif
 
-    Logger::getInstance().debug("Socket timeouts configured (30s)");
+    LOG_DEBUG("Socket timeouts configured (30s)");
 
     /* -------------------------------------------------------------------------
        SET KEEPALIVE (detect dead TCP connections)
@@ -315,7 +522,7 @@ void RedisServer::handleClient(socket_t client_fd)
     }
 #endif
 
-    Logger::getInstance().debug("TCP keepalive configured");
+    LOG_DEBUG("TCP keepalive configured");
 
     /* ------------------------------ SEND ALL ------------------------------ */
     auto sendAll = [&](socket_t fd, const std::string &data) -> bool
@@ -387,7 +594,7 @@ void RedisServer::handleClient(socket_t client_fd)
             // treat timeouts / would-block / interrupts as transient: continue to next loop iteration
             if (we == WSAEWOULDBLOCK || we == WSAEINTR || we == WSAETIMEDOUT)
             {
-                Logger::getInstance().debug("recv transient WSA=" + std::to_string(we));
+                LOG_DEBUG("recv transient WSA=" + std::to_string(we));
                 // allow server to keep connection alive a bit
                 std::this_thread::sleep_for(std::chrono::milliseconds(5));
                 continue;
@@ -411,7 +618,7 @@ void RedisServer::handleClient(socket_t client_fd)
             }
             if (errno == EAGAIN || errno == EWOULDBLOCK)
             {
-                Logger::getInstance().debug("recv would block (EAGAIN/EWOULDBLOCK), continuing");
+                LOG_DEBUG("recv would block (EAGAIN/EWOULDBLOCK), continuing");
                 std::this_thread::sleep_for(std::chrono::milliseconds(5));
                 continue;
             }
@@ -426,6 +633,7 @@ void RedisServer::handleClient(socket_t client_fd)
 #else
         buffer.append(recvbuf.data(), static_cast<size_t>(bytes));
 #endif
+        ServerStats::getInstance().addBytesIn(static_cast<uint64_t>(bytes));
 
         if (buffer.size() > MAX_BUFFER)
         {
@@ -434,7 +642,7 @@ void RedisServer::handleClient(socket_t client_fd)
             break;
         }
 
-        std::vector<std::string> frames;
+        RedisCommandHandler::RespFrames frames;
         try
         {
             frames = handler.splitFrames(buffer);
@@ -466,28 +674,32 @@ void RedisServer::handleClient(socket_t client_fd)
             continue;
         }
 
-        // Process all complete frames (if any)
+        // Process all complete frames, coalescing their responses into one
+        // output buffer so a pipelined batch costs a single send() syscall
+        // instead of one per command.
+        outbuf.clear();
         for (auto &frame : frames)
         {
-            std::string resp;
             try
             {
-                resp = handler.processCommand(frame);
+                outbuf += handler.processCommand(frame);
             }
             catch (const std::exception &ex)
             {
                 Logger::getInstance().warn("processCommand threw: " + std::string(ex.what()));
-                resp = "-ERR internal error\r\n";
+                outbuf += "-ERR internal error\r\n";
             }
             catch (...)
             {
                 Logger::getInstance().warn("processCommand threw unknown exception");
-                resp = "-ERR internal error\r\n";
+                outbuf += "-ERR internal error\r\n";
             }
-
-            if (!sendAll(client_fd, resp))
-                goto close_conn;
         }
+
+        if (!sendAll(client_fd, outbuf))
+            goto close_conn;
+
+        ServerStats::getInstance().addBytesOut(outbuf.size());
     }
 
 close_conn:
@@ -497,4 +709,840 @@ close_conn:
     ::shutdown(client_fd, SHUT_RDWR);
 #endif
     CLOSE_SOCKET(client_fd);
+    ServerStats::getInstance().connectionClosed();
+}
+
+/* ============================================================
+   EVENT LOOP MODE (epoll on Linux, kqueue on BSD/mac)
+
+   A small set of I/O threads multiplex every client socket
+   instead of parking one ThreadPool worker per connection.
+   Parsing and command execution reuse the exact same
+   splitFrames/processCommand path as handleClient.
+   ============================================================ */
+#if defined(HAVE_EPOLL) || defined(HAVE_KQUEUE)
+
+namespace
+{
+    // Minimal poller shim so the loop body reads the same on both backends.
+    struct PollerEvent
+    {
+        socket_t fd;
+        bool readable;
+        bool writable;
+        bool error;
+    };
+
+    void setNonBlocking(socket_t fd)
+    {
+        int fl = fcntl(fd, F_GETFL, 0);
+        if (fl >= 0)
+            fcntl(fd, F_SETFL, fl | O_NONBLOCK);
+    }
+
+#ifdef HAVE_EPOLL
+    int pollerCreate() { return epoll_create1(0); }
+
+    bool pollerAdd(int pfd, socket_t fd, bool want_write, bool exclusive)
+    {
+        epoll_event ev{};
+        ev.events = EPOLLIN | (want_write ? EPOLLOUT : 0u);
+#ifdef EPOLLEXCLUSIVE
+        if (exclusive)
+            ev.events |= EPOLLEXCLUSIVE; // spread accept wakeups across loops
+#else
+        (void)exclusive;
+#endif
+        ev.data.fd = fd;
+        return epoll_ctl(pfd, EPOLL_CTL_ADD, fd, &ev) == 0;
+    }
+
+    void pollerMod(int pfd, socket_t fd, bool want_write)
+    {
+        epoll_event ev{};
+        ev.events = EPOLLIN | (want_write ? EPOLLOUT : 0u);
+        ev.data.fd = fd;
+        epoll_ctl(pfd, EPOLL_CTL_MOD, fd, &ev);
+    }
+
+    void pollerDel(int pfd, socket_t fd)
+    {
+        epoll_ctl(pfd, EPOLL_CTL_DEL, fd, nullptr);
+    }
+
+    int pollerWait(int pfd, PollerEvent *out, int max, int timeout_ms)
+    {
+        epoll_event evs[64];
+        if (max > 64)
+            max = 64;
+
+        int n = epoll_wait(pfd, evs, max, timeout_ms);
+        for (int i = 0; i < n; i++)
+        {
+            out[i].fd = evs[i].data.fd;
+            out[i].readable = (evs[i].events & EPOLLIN) != 0;
+            out[i].writable = (evs[i].events & EPOLLOUT) != 0;
+            out[i].error = (evs[i].events & (EPOLLERR | EPOLLHUP)) != 0;
+        }
+        return n;
+    }
+#else // HAVE_KQUEUE
+    int pollerCreate() { return kqueue(); }
+
+    bool pollerAdd(int pfd, socket_t fd, bool want_write, bool /*exclusive*/)
+    {
+        struct kevent evs[2];
+        int n = 0;
+        EV_SET(&evs[n++], fd, EVFILT_READ, EV_ADD, 0, 0, nullptr);
+        if (want_write)
+            EV_SET(&evs[n++], fd, EVFILT_WRITE, EV_ADD, 0, 0, nullptr);
+        return kevent(pfd, evs, n, nullptr, 0, nullptr) == 0;
+    }
+
+    void pollerMod(int pfd, socket_t fd, bool want_write)
+    {
+        struct kevent ev;
+        EV_SET(&ev, fd, EVFILT_WRITE, want_write ? EV_ADD : EV_DELETE, 0, 0, nullptr);
+        kevent(pfd, &ev, 1, nullptr, 0, nullptr);
+    }
+
+    void pollerDel(int pfd, socket_t fd)
+    {
+        struct kevent evs[2];
+        EV_SET(&evs[0], fd, EVFILT_READ, EV_DELETE, 0, 0, nullptr);
+        EV_SET(&evs[1], fd, EVFILT_WRITE, EV_DELETE, 0, 0, nullptr);
+        kevent(pfd, evs, 2, nullptr, 0, nullptr);
+    }
+
+    int pollerWait(int pfd, PollerEvent *out, int max, int timeout_ms)
+    {
+        struct kevent evs[64];
+        if (max > 64)
+            max = 64;
+
+        struct timespec ts;
+        ts.tv_sec = timeout_ms / 1000;
+        ts.tv_nsec = (timeout_ms % 1000) * 1000000L;
+
+        int n = kevent(pfd, nullptr, 0, evs, max, &ts);
+        for (int i = 0; i < n; i++)
+        {
+            out[i].fd = (socket_t)evs[i].ident;
+            out[i].readable = (evs[i].filter == EVFILT_READ);
+            out[i].writable = (evs[i].filter == EVFILT_WRITE);
+            out[i].error = (evs[i].flags & EV_ERROR) != 0;
+        }
+        return n;
+    }
+#endif
+} // namespace
+
+void RedisServer::runEventLoop()
+{
+    for (socket_t fd : listen_sockets)
+        setNonBlocking(fd);
+
+    unsigned hw = std::thread::hardware_concurrency();
+    int io_threads = (int)std::min(4u, hw ? hw : 1u);
+
+    // Every reuseport listener needs a loop draining it
+    if (io_threads < (int)listen_sockets.size())
+        io_threads = (int)listen_sockets.size();
+
+    Logger::getInstance().info("Event loop mode: " + std::to_string(io_threads) + " I/O threads");
+
+    std::vector<std::thread> loops;
+    loops.reserve(io_threads);
+    for (int i = 0; i < io_threads; i++)
+        loops.emplace_back([this, i, io_threads]()
+                           { eventLoopThread(i, io_threads); });
+
+    for (auto &t : loops)
+        if (t.joinable())
+            t.join();
 }
+
+void RedisServer::eventLoopThread(int thread_index, int io_threads)
+{
+    int pfd = pollerCreate();
+    if (pfd < 0)
+    {
+        Logger::getInstance().error("Poller creation failed errno=" + std::to_string(errno));
+        return;
+    }
+
+    // This loop's listener. With one reuseport listener per loop each
+    // socket has a single owner; when loops outnumber listeners a socket
+    // is shared by several loops.
+    socket_t listen_fd = listen_sockets[thread_index % listen_sockets.size()];
+    bool shared_listener = io_threads > (int)listen_sockets.size();
+
+#ifdef HAVE_EPOLL
+    // EPOLLEXCLUSIVE on shared listeners: every loop polls, the kernel
+    // wakes one.
+    pollerAdd(pfd, listen_fd, false, shared_listener);
+#else
+    // kqueue has no EXCLUSIVE flag: the first io_thread of each listener
+    // is its sole acceptor, avoiding thundering herd on shared sockets.
+    if (thread_index < (int)listen_sockets.size())
+        pollerAdd(pfd, listen_fd, false, false);
+    else
+        listen_fd = INVALID_SOCKET_T;
+    (void)shared_listener;
+#endif
+
+    // Per-connection state owned by this loop: input buffer accumulating
+    // partial frames, pending output when the socket would block, and the
+    // connection's command handler.
+    struct Conn
+    {
+        std::string inbuf;
+        std::string outbuf;
+        RedisCommandHandler handler;
+        bool want_write = false;
+    };
+
+    std::unordered_map<socket_t, Conn> conns;
+    const size_t MAX_BUFFER = 4 * 1024 * 1024;
+    std::vector<char> recvbuf(8192);
+    PollerEvent events[64];
+
+    auto closeConn = [&](socket_t fd)
+    {
+        pollerDel(pfd, fd);
+        CLOSE_SOCKET(fd);
+        conns.erase(fd);
+        ServerStats::getInstance().connectionClosed();
+    };
+
+    // Push as much of outbuf as the socket accepts; arm EPOLLOUT for the rest.
+    // Returns false if the connection died.
+    auto flushConn = [&](socket_t fd, Conn &c) -> bool
+    {
+        while (!c.outbuf.empty())
+        {
+            ssize_t sent = ::send(fd, c.outbuf.data(), c.outbuf.size(), 0);
+            if (sent > 0)
+            {
+                ServerStats::getInstance().addBytesOut((uint64_t)sent);
+                c.outbuf.erase(0, (size_t)sent);
+                continue;
+            }
+            if (sent < 0 && errno == EINTR)
+                continue;
+            if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                break;
+            return false; // peer gone
+        }
+
+        bool need_write = !c.outbuf.empty();
+        if (need_write != c.want_write)
+        {
+            c.want_write = need_write;
+            pollerMod(pfd, fd, need_write);
+        }
+        return true;
+    };
+
+    while (running.load(std::memory_order_acquire))
+    {
+        int n = pollerWait(pfd, events, 64, 100);
+
+        for (int i = 0; i < n; i++)
+        {
+            PollerEvent &ev = events[i];
+
+            /* ---------------- new connections ---------------- */
+            if (ev.fd == listen_fd)
+            {
+                while (true)
+                {
+                    socket_t cfd = accept(listen_fd, nullptr, nullptr);
+                    if (cfd < 0)
+                        break;
+
+                    setNonBlocking(cfd);
+                    int flag = 1;
+                    setsockopt(cfd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+
+                    conns.emplace(cfd, Conn{});
+                    pollerAdd(pfd, cfd, false, false);
+                    ServerStats::getInstance().connectionOpened();
+                }
+                continue;
+            }
+
+            auto it = conns.find(ev.fd);
+            if (it == conns.end())
+                continue;
+            Conn &c = it->second;
+
+            if (ev.error)
+            {
+                closeConn(ev.fd);
+                continue;
+            }
+
+            /* ---------------- readable ---------------- */
+            if (ev.readable)
+            {
+                bool closed = false;
+                while (true)
+                {
+                    ssize_t bytes = ::recv(ev.fd, recvbuf.data(), recvbuf.size(), 0);
+                    if (bytes > 0)
+                    {
+                        ServerStats::getInstance().addBytesIn((uint64_t)bytes);
+                        c.inbuf.append(recvbuf.data(), (size_t)bytes);
+                        if (c.inbuf.size() > MAX_BUFFER)
+                        {
+                            Logger::getInstance().warn("payload too large (" + std::to_string(c.inbuf.size()) + ")");
+                            ::send(ev.fd, "-ERR payload too large\r\n", 24, 0);
+                            closed = true;
+                        }
+                        continue;
+                    }
+                    if (bytes == 0)
+                    {
+                        closed = true;
+                        break;
+                    }
+                    if (errno == EINTR)
+                        continue;
+                    if (errno == EAGAIN || errno == EWOULDBLOCK)
+                        break;
+                    closed = true;
+                    break;
+                }
+
+                // Parse and execute whatever complete frames we have;
+                // partial input simply stays in inbuf for the next recv.
+                RedisCommandHandler::RespFrames frames;
+                try
+                {
+                    frames = c.handler.splitFrames(c.inbuf);
+                }
+                catch (...)
+                {
+                    // parser saw partial/garbled input: wait for more bytes
+                }
+
+                for (auto &frame : frames)
+                {
+                    try
+                    {
+                        c.outbuf += c.handler.processCommand(frame);
+                    }
+                    catch (const std::exception &ex)
+                    {
+                        Logger::getInstance().warn("processCommand threw: " + std::string(ex.what()));
+                        c.outbuf += "-ERR internal error\r\n";
+                    }
+                    catch (...)
+                    {
+                        c.outbuf += "-ERR internal error\r\n";
+                    }
+                }
+
+                if (!flushConn(ev.fd, c) || closed)
+                {
+                    closeConn(ev.fd);
+                    continue;
+                }
+            }
+
+            /* ---------------- writable ---------------- */
+            if (ev.writable)
+            {
+                if (!flushConn(ev.fd, c))
+                    closeConn(ev.fd);
+            }
+        }
+    }
+
+    for (auto &p : conns)
+        CLOSE_SOCKET(p.first);
+    close(pfd);
+}
+
+#else // no poller support on this platform
+
+void RedisServer::runEventLoop()
+{
+    Logger::getInstance().warn("Event loop unsupported on this platform; using thread-per-connection");
+    runAcceptLoop(server_socket);
+}
+
+void RedisServer::eventLoopThread(int, int) {}
+
+#endif
+
+/* ============================================================
+   IO_URING MODE (Linux)
+
+   One ring per I/O thread. accept/recv/send are submitted as
+   SQEs and completions drive dispatch, so a batch of ready
+   connections is serviced with a single io_uring_enter instead
+   of a recv+send syscall pair each. The rings are built on the
+   raw kernel interface (io_uring_setup / io_uring_enter plus
+   ring mmaps) so no extra library is needed; command parsing
+   and execution reuse the splitFrames/processCommand path.
+   ============================================================ */
+#ifdef HAVE_IO_URING
+
+namespace
+{
+    // Minimal single-threaded wrapper around one io_uring instance.
+    struct UringQueue
+    {
+        int ring_fd = -1;
+        unsigned entries = 0;
+        bool ext_arg = false; // IORING_FEAT_EXT_ARG: timed waits
+
+        unsigned *sq_head = nullptr, *sq_tail = nullptr;
+        unsigned *sq_mask = nullptr, *sq_array = nullptr;
+        io_uring_sqe *sqes = nullptr;
+
+        unsigned *cq_head = nullptr, *cq_tail = nullptr, *cq_mask = nullptr;
+        io_uring_cqe *cqes = nullptr;
+
+        void *sq_mmap = nullptr, *cq_mmap = nullptr, *sqe_mmap = nullptr;
+        size_t sq_bytes = 0, cq_bytes = 0, sqe_bytes = 0;
+
+        unsigned local_tail = 0; // SQEs written but not yet published
+        unsigned to_submit = 0;
+
+        bool init(unsigned n)
+        {
+            io_uring_params p{};
+            ring_fd = (int)syscall(__NR_io_uring_setup, n, &p);
+            if (ring_fd < 0)
+                return false;
+
+            entries = p.sq_entries;
+            ext_arg = (p.features & IORING_FEAT_EXT_ARG) != 0;
+
+            sq_bytes = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+            cq_bytes = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+            bool single = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+            if (single)
+                sq_bytes = cq_bytes = std::max(sq_bytes, cq_bytes);
+
+            sq_mmap = mmap(nullptr, sq_bytes, PROT_READ | PROT_WRITE,
+                           MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+            if (sq_mmap == MAP_FAILED)
+                return fail();
+
+            cq_mmap = single ? sq_mmap
+                             : mmap(nullptr, cq_bytes, PROT_READ | PROT_WRITE,
+                                    MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+            if (cq_mmap == MAP_FAILED)
+                return fail();
+
+            sqe_bytes = p.sq_entries * sizeof(io_uring_sqe);
+            sqe_mmap = mmap(nullptr, sqe_bytes, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+            if (sqe_mmap == MAP_FAILED)
+                return fail();
+
+            char *sq = (char *)sq_mmap;
+            sq_head = (unsigned *)(sq + p.sq_off.head);
+            sq_tail = (unsigned *)(sq + p.sq_off.tail);
+            sq_mask = (unsigned *)(sq + p.sq_off.ring_mask);
+            sq_array = (unsigned *)(sq + p.sq_off.array);
+            sqes = (io_uring_sqe *)sqe_mmap;
+
+            char *cq = (char *)cq_mmap;
+            cq_head = (unsigned *)(cq + p.cq_off.head);
+            cq_tail = (unsigned *)(cq + p.cq_off.tail);
+            cq_mask = (unsigned *)(cq + p.cq_off.ring_mask);
+            cqes = (io_uring_cqe *)(cq + p.cq_off.cqes);
+
+            local_tail = *sq_tail;
+            return true;
+        }
+
+        bool fail()
+        {
+            destroy();
+            return false;
+        }
+
+        void destroy()
+        {
+            if (sqe_mmap && sqe_mmap != MAP_FAILED)
+                munmap(sqe_mmap, sqe_bytes);
+            if (cq_mmap && cq_mmap != MAP_FAILED && cq_mmap != sq_mmap)
+                munmap(cq_mmap, cq_bytes);
+            if (sq_mmap && sq_mmap != MAP_FAILED)
+                munmap(sq_mmap, sq_bytes);
+            sq_mmap = cq_mmap = sqe_mmap = nullptr;
+            if (ring_fd >= 0)
+                close(ring_fd);
+            ring_fd = -1;
+        }
+
+        // Next free SQE (zeroed), or nullptr when the ring is full —
+        // the caller then flushes with submitAndWait and retries.
+        io_uring_sqe *getSqe()
+        {
+            unsigned head = __atomic_load_n(sq_head, __ATOMIC_ACQUIRE);
+            if (local_tail - head >= entries)
+                return nullptr;
+
+            unsigned idx = local_tail & *sq_mask;
+            io_uring_sqe *sqe = &sqes[idx];
+            std::memset(sqe, 0, sizeof(*sqe));
+            sq_array[idx] = idx;
+            local_tail++;
+            to_submit++;
+            return sqe;
+        }
+
+        // Publish queued SQEs and wait up to timeout_ms for ≥1 completion
+        int submitAndWait(int timeout_ms)
+        {
+            __atomic_store_n(sq_tail, local_tail, __ATOMIC_RELEASE);
+
+            unsigned flags = IORING_ENTER_GETEVENTS;
+            int ret;
+
+#ifdef IORING_ENTER_EXT_ARG
+            if (ext_arg)
+            {
+                struct __kernel_timespec ts{};
+                ts.tv_nsec = (long long)timeout_ms * 1000000LL;
+                io_uring_getevents_arg arg{};
+                arg.ts = (unsigned long long)(uintptr_t)&ts;
+                ret = (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, 1,
+                                   flags | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+            }
+            else
+#endif
+            {
+                // Old kernel without timed waits: submit without blocking and
+                // poll; slightly busier, but only a fallback path.
+                ret = (int)syscall(__NR_io_uring_enter, ring_fd, to_submit, 0,
+                                   flags, nullptr, 0);
+                if (ret >= 0 && !hasCqe())
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+
+            if (ret >= 0 || errno == ETIME || errno == EINTR)
+            {
+                to_submit = 0;
+                return 0;
+            }
+            return -errno;
+        }
+
+        bool hasCqe() const
+        {
+            return *cq_head != __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+        }
+
+        bool nextCqe(io_uring_cqe &out)
+        {
+            unsigned head = *cq_head;
+            if (head == __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE))
+                return false;
+            out = cqes[head & *cq_mask];
+            __atomic_store_n(cq_head, head + 1, __ATOMIC_RELEASE);
+            return true;
+        }
+    };
+
+    // user_data encoding: operation tag in the high bits, fd below
+    constexpr uint64_t URING_OP_ACCEPT = 1;
+    constexpr uint64_t URING_OP_RECV = 2;
+    constexpr uint64_t URING_OP_SEND = 3;
+
+    inline uint64_t uringTag(uint64_t op, socket_t fd)
+    {
+        return (op << 32) | (uint32_t)fd;
+    }
+}
+
+bool RedisServer::runUringLoop()
+{
+    // Probe once: a sandboxed or old kernel fails here and we report
+    // that to run(), which falls back to the epoll event loop.
+    {
+        UringQueue probe;
+        if (!probe.init(8))
+        {
+            Logger::getInstance().warn("io_uring_setup failed errno=" + std::to_string(errno));
+            return false;
+        }
+        probe.destroy();
+    }
+
+    unsigned hw = std::thread::hardware_concurrency();
+    int io_threads = (int)std::min(4u, hw ? hw : 1u);
+    if (io_threads < (int)listen_sockets.size())
+        io_threads = (int)listen_sockets.size();
+
+    Logger::getInstance().info("io_uring mode: " + std::to_string(io_threads) + " rings");
+
+    std::vector<std::thread> loops;
+    loops.reserve(io_threads);
+    for (int i = 0; i < io_threads; i++)
+        loops.emplace_back([this, i, io_threads]()
+                           { uringLoopThread(i, io_threads); });
+
+    for (auto &t : loops)
+        if (t.joinable())
+            t.join();
+    return true;
+}
+
+void RedisServer::uringLoopThread(int thread_index, int io_threads)
+{
+    (void)io_threads;
+
+    UringQueue ring;
+    if (!ring.init(256))
+    {
+        Logger::getInstance().error("io_uring ring init failed errno=" + std::to_string(errno));
+        return;
+    }
+
+    // Per-loop listener, as in eventLoopThread: reuseport listeners each
+    // get one owner; otherwise loops share the socket (each keeps its own
+    // accept SQE in flight and the kernel picks one per connection).
+    socket_t listen_fd = listen_sockets[thread_index % listen_sockets.size()];
+
+    // Connection state owned by this ring. At most one recv and one send
+    // SQE are in flight per connection; `sending` pins the bytes of the
+    // in-flight send while `outbuf` keeps accumulating new responses.
+    struct Conn
+    {
+        std::string inbuf;
+        std::string outbuf;
+        std::string sending;
+        std::vector<char> rbuf = std::vector<char>(8192);
+        RedisCommandHandler handler;
+        int pending = 0;      // submitted, uncompleted ops
+        bool closing = false; // fd shut down, draining completions
+    };
+
+    std::unordered_map<socket_t, Conn> conns;
+    const size_t MAX_BUFFER = 4 * 1024 * 1024;
+
+    auto getSqe = [&]() -> io_uring_sqe *
+    {
+        io_uring_sqe *sqe = ring.getSqe();
+        while (!sqe) // ring full: flush and retry
+        {
+            ring.submitAndWait(0);
+            sqe = ring.getSqe();
+        }
+        return sqe;
+    };
+
+    auto submitAccept = [&]()
+    {
+        io_uring_sqe *sqe = getSqe();
+        sqe->opcode = IORING_OP_ACCEPT;
+        sqe->fd = listen_fd;
+        sqe->user_data = uringTag(URING_OP_ACCEPT, listen_fd);
+    };
+
+    auto submitRecv = [&](socket_t fd, Conn &c)
+    {
+        io_uring_sqe *sqe = getSqe();
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = fd;
+        sqe->addr = (uint64_t)(uintptr_t)c.rbuf.data();
+        sqe->len = (uint32_t)c.rbuf.size();
+        sqe->user_data = uringTag(URING_OP_RECV, fd);
+        c.pending++;
+    };
+
+    auto submitSend = [&](socket_t fd, Conn &c)
+    {
+        io_uring_sqe *sqe = getSqe();
+        sqe->opcode = IORING_OP_SEND;
+        sqe->fd = fd;
+        sqe->addr = (uint64_t)(uintptr_t)c.sending.data();
+        sqe->len = (uint32_t)c.sending.size();
+        sqe->msg_flags = MSG_NOSIGNAL;
+        sqe->user_data = uringTag(URING_OP_SEND, fd);
+        c.pending++;
+    };
+
+    // Close protocol: shutdown() forces in-flight ops to complete, the fd
+    // stays open (so its number cannot be reused against stale user_data)
+    // until the last completion drains, then we erase the connection.
+    auto beginClose = [&](socket_t fd, Conn &c)
+    {
+        if (c.closing)
+            return;
+        c.closing = true;
+        ::shutdown(fd, SHUT_RDWR);
+        if (c.pending == 0)
+        {
+            CLOSE_SOCKET(fd);
+            conns.erase(fd);
+            ServerStats::getInstance().connectionClosed();
+        }
+    };
+
+    auto finishOp = [&](socket_t fd, Conn &c) -> bool
+    {
+        c.pending--;
+        if (c.closing && c.pending == 0)
+        {
+            CLOSE_SOCKET(fd);
+            conns.erase(fd);
+            ServerStats::getInstance().connectionClosed();
+            return true; // conn gone
+        }
+        return false;
+    };
+
+    submitAccept();
+
+    while (running.load(std::memory_order_acquire))
+    {
+        if (ring.submitAndWait(100) < 0)
+            break;
+
+        io_uring_cqe cqe;
+        while (ring.nextCqe(cqe))
+        {
+            uint64_t op = cqe.user_data >> 32;
+            socket_t fd = (socket_t)(uint32_t)cqe.user_data;
+
+            /* ---------------- accepted ---------------- */
+            if (op == URING_OP_ACCEPT)
+            {
+                if (cqe.res >= 0)
+                {
+                    socket_t cfd = (socket_t)cqe.res;
+                    int flag = 1;
+                    setsockopt(cfd, IPPROTO_TCP, TCP_NODELAY, &flag, sizeof(flag));
+
+                    Conn &c = conns[cfd];
+                    submitRecv(cfd, c);
+                    ServerStats::getInstance().connectionOpened();
+                }
+                else if (!running.load(std::memory_order_acquire))
+                {
+                    continue; // listener closed during shutdown
+                }
+                submitAccept(); // re-arm
+                continue;
+            }
+
+            auto it = conns.find(fd);
+            if (it == conns.end())
+                continue;
+            Conn &c = it->second;
+
+            /* ---------------- received ---------------- */
+            if (op == URING_OP_RECV)
+            {
+                if (finishOp(fd, c))
+                    continue;
+
+                if (cqe.res <= 0)
+                {
+                    if (cqe.res == -EINTR)
+                    {
+                        submitRecv(fd, c);
+                        continue;
+                    }
+                    beginClose(fd, c);
+                    continue;
+                }
+
+                ServerStats::getInstance().addBytesIn((uint64_t)cqe.res);
+                c.inbuf.append(c.rbuf.data(), (size_t)cqe.res);
+
+                if (c.inbuf.size() > MAX_BUFFER)
+                {
+                    Logger::getInstance().warn("payload too large (" + std::to_string(c.inbuf.size()) + ")");
+                    beginClose(fd, c);
+                    continue;
+                }
+
+                RedisCommandHandler::RespFrames frames;
+                try
+                {
+                    frames = c.handler.splitFrames(c.inbuf);
+                }
+                catch (...)
+                {
+                    // partial/garbled input: wait for more bytes
+                }
+
+                for (auto &frame : frames)
+                {
+                    try
+                    {
+                        c.outbuf += c.handler.processCommand(frame);
+                    }
+                    catch (const std::exception &ex)
+                    {
+                        Logger::getInstance().warn("processCommand threw: " + std::string(ex.what()));
+                        c.outbuf += "-ERR internal error\r\n";
+                    }
+                    catch (...)
+                    {
+                        c.outbuf += "-ERR internal error\r\n";
+                    }
+                }
+
+                if (!c.outbuf.empty() && c.sending.empty())
+                {
+                    c.sending.swap(c.outbuf);
+                    submitSend(fd, c);
+                }
+
+                submitRecv(fd, c);
+                continue;
+            }
+
+            /* ---------------- sent ---------------- */
+            if (op == URING_OP_SEND)
+            {
+                if (finishOp(fd, c))
+                    continue;
+
+                if (cqe.res < 0)
+                {
+                    if (cqe.res == -EINTR)
+                    {
+                        submitSend(fd, c);
+                        continue;
+                    }
+                    beginClose(fd, c);
+                    continue;
+                }
+
+                ServerStats::getInstance().addBytesOut((uint64_t)cqe.res);
+                c.sending.erase(0, (size_t)cqe.res);
+
+                // Short write: push the rest. Otherwise pick up whatever
+                // accumulated while this send was in flight.
+                if (c.sending.empty() && !c.outbuf.empty())
+                    c.sending.swap(c.outbuf);
+
+                if (!c.sending.empty())
+                    submitSend(fd, c);
+            }
+        }
+    }
+
+    for (auto &p : conns)
+        CLOSE_SOCKET(p.first);
+    ring.destroy();
+}
+
+#else // !HAVE_IO_URING
+
+bool RedisServer::runUringLoop() { return false; }
+void RedisServer::uringLoopThread(int, int) {}
+
+#endif
@@ -0,0 +1,504 @@
+#include "../include/Replication.h"
+#include "../include/RedisDatabase.h"
+#include "../include/RedisCommandHandler.h"
+#include "../include/Logger.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+/* -----------------------------------------------------------------------------
+   Singleton
+----------------------------------------------------------------------------- */
+Replication &Replication::getInstance()
+{
+    static Replication inst;
+    return inst;
+}
+
+/* -----------------------------------------------------------------------------
+   Thread-local stream-apply flag (bypasses the -READONLY check while the
+   replica thread replays the master's commands)
+----------------------------------------------------------------------------- */
+namespace
+{
+    thread_local bool tls_applying_stream = false;
+}
+
+bool Replication::applyingStream()
+{
+    return tls_applying_stream;
+}
+
+#ifndef _WIN32
+
+/* -----------------------------------------------------------------------------
+   Socket helpers (blocking fds, replication links are few and long-lived)
+----------------------------------------------------------------------------- */
+namespace
+{
+    bool sendAllFd(socket_t fd, const char *data, size_t len)
+    {
+        size_t off = 0;
+        while (off < len)
+        {
+            ssize_t n = ::send(fd, data + off, len - off, MSG_NOSIGNAL);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return false;
+            }
+            off += (size_t)n;
+        }
+        return true;
+    }
+
+    bool sendAllFd(socket_t fd, const std::string &data)
+    {
+        return sendAllFd(fd, data.data(), data.size());
+    }
+
+    // Read until buf holds at least want bytes; false on EOF/error
+    bool recvAtLeast(socket_t fd, std::string &buf, size_t want)
+    {
+        char chunk[16384];
+        while (buf.size() < want)
+        {
+            ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+            if (n <= 0)
+            {
+                if (n < 0 && errno == EINTR)
+                    continue;
+                return false;
+            }
+            buf.append(chunk, (size_t)n);
+        }
+        return true;
+    }
+
+    // Read until buf contains a '\n'; false on EOF/error
+    bool recvLine(socket_t fd, std::string &buf)
+    {
+        while (buf.find('\n') == std::string::npos)
+        {
+            size_t have = buf.size();
+            if (!recvAtLeast(fd, buf, have + 1))
+                return false;
+        }
+        return true;
+    }
+}
+
+/* =============================================================================
+                                MASTER SIDE
+============================================================================= */
+bool Replication::startMaster(int repl_port)
+{
+    if (master_running.load(std::memory_order_acquire))
+        return true;
+
+    socket_t fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+    {
+        Logger::getInstance().error("Replication socket failed errno=" +
+                                    std::to_string(errno));
+        return false;
+    }
+
+    int opt = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)repl_port);
+    addr.sin_addr.s_addr = INADDR_ANY;
+
+    if (bind(fd, (sockaddr *)&addr, sizeof(addr)) < 0 || listen(fd, 16) < 0)
+    {
+        Logger::getInstance().error("Replication listener bind/listen failed errno=" +
+                                    std::to_string(errno));
+        ::close(fd);
+        return false;
+    }
+
+    listen_fd = fd;
+    master_running.store(true, std::memory_order_release);
+    accept_thread = std::thread(&Replication::acceptLoop, this);
+
+    Logger::getInstance().info("Replication listener on port " +
+                               std::to_string(repl_port));
+    return true;
+}
+
+void Replication::acceptLoop()
+{
+    while (master_running.load(std::memory_order_acquire))
+    {
+        reapDeadLinks();
+
+        socket_t cfd = ::accept(listen_fd, nullptr, nullptr);
+        if (cfd < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            break; // listener closed on shutdown
+        }
+
+        int one = 1;
+        setsockopt(cfd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+        auto link = std::make_unique<ReplicaLink>();
+        link->fd = cfd;
+        ReplicaLink *raw = link.get();
+
+        {
+            std::lock_guard<std::mutex> lock(links_mutex);
+            links.push_back(std::move(link));
+        }
+
+        raw->thread = std::thread(&Replication::serveReplica, this, raw);
+    }
+}
+
+void Replication::reapDeadLinks()
+{
+    std::lock_guard<std::mutex> lock(links_mutex);
+    for (auto it = links.begin(); it != links.end();)
+    {
+        if ((*it)->dead.load(std::memory_order_acquire))
+        {
+            if ((*it)->thread.joinable())
+                (*it)->thread.join();
+            it = links.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+// Handshake, snapshot, then stream. The link is attached to propagate()
+// BEFORE the snapshot is written, so writes that land during the dump
+// are buffered and flushed right after it — nothing is lost (a racing
+// write may appear in both; see the header).
+void Replication::serveReplica(ReplicaLink *link)
+{
+    Logger::getInstance().info("Replica connected, starting sync");
+
+    std::string line;
+    bool ok = recvLine(link->fd, line) && line.rfind("SYNC", 0) == 0;
+
+    if (ok)
+    {
+        link->attached.store(true, std::memory_order_release);
+        replica_count.fetch_add(1, std::memory_order_relaxed);
+
+        std::string tmp = "repl-sync-" + std::to_string((int)link->fd) + ".my_rdb";
+        ok = RedisDatabase::getInstance().dump(tmp);
+
+        if (ok)
+        {
+            std::ifstream in(tmp, std::ios::binary);
+            std::ostringstream payload;
+            payload << in.rdbuf();
+            std::string snap = payload.str();
+            std::remove(tmp.c_str());
+
+            std::string header = "$" + std::to_string(snap.size()) + "\r\n";
+            ok = sendAllFd(link->fd, header) &&
+                 sendAllFd(link->fd, snap) &&
+                 sendAllFd(link->fd, "\r\n");
+
+            if (ok)
+                Logger::getInstance().info("Replica sync done (" +
+                                           std::to_string(snap.size()) + " bytes)");
+        }
+        else
+        {
+            Logger::getInstance().error("Replication snapshot dump failed");
+        }
+    }
+
+    // Stream loop: drain buf as propagate() fills it
+    std::string pending;
+    while (ok && master_running.load(std::memory_order_acquire))
+    {
+        {
+            std::unique_lock<std::mutex> lock(link->mutex);
+            link->cv.wait_for(lock, std::chrono::milliseconds(200),
+                              [&]
+                              { return !link->buf.empty() ||
+                                       !master_running.load(std::memory_order_acquire); });
+            pending.clear();
+            pending.swap(link->buf);
+        }
+
+        if (!pending.empty() && !sendAllFd(link->fd, pending))
+        {
+            ok = false;
+            Logger::getInstance().warn("Replica link send failed, dropping replica");
+        }
+    }
+
+    if (link->attached.exchange(false, std::memory_order_acq_rel))
+        replica_count.fetch_sub(1, std::memory_order_relaxed);
+
+    ::close(link->fd);
+    link->dead.store(true, std::memory_order_release);
+}
+
+void Replication::propagate(std::string_view frame)
+{
+    if (replica_count.load(std::memory_order_relaxed) == 0)
+        return;
+
+    std::lock_guard<std::mutex> lock(links_mutex);
+    for (auto &l : links)
+    {
+        if (!l->attached.load(std::memory_order_acquire))
+            continue;
+        std::lock_guard<std::mutex> ll(l->mutex);
+        l->buf.append(frame.data(), frame.size());
+        l->cv.notify_one();
+    }
+}
+
+/* =============================================================================
+                                REPLICA SIDE
+============================================================================= */
+void Replication::replicaOf(const std::string &host, int port)
+{
+    stopReplication();
+
+    {
+        std::lock_guard<std::mutex> lock(repl_mutex);
+        master_host = host;
+        master_port = port;
+    }
+
+    replica_mode.store(true, std::memory_order_release);
+    uint64_t epoch = link_epoch.fetch_add(1, std::memory_order_acq_rel) + 1;
+
+    std::lock_guard<std::mutex> lock(repl_mutex);
+    replica_thread = std::thread(&Replication::replicaLoop, this, epoch);
+
+    Logger::getInstance().info("Now a replica of " + host + ":" +
+                               std::to_string(port));
+}
+
+void Replication::stopReplication()
+{
+    if (!replica_mode.exchange(false, std::memory_order_acq_rel))
+        return;
+
+    link_epoch.fetch_add(1, std::memory_order_acq_rel);
+
+    socket_t fd = link_fd.exchange(INVALID_SOCKET_T, std::memory_order_acq_rel);
+    if (fd != INVALID_SOCKET_T)
+        ::shutdown(fd, SHUT_RDWR); // wakes the blocking recv; thread closes it
+
+    std::thread t;
+    {
+        std::lock_guard<std::mutex> lock(repl_mutex);
+        t.swap(replica_thread);
+    }
+    if (t.joinable())
+        t.join();
+
+    link_up.store(false, std::memory_order_relaxed);
+    Logger::getInstance().info("Replication stopped (now a master)");
+}
+
+std::string Replication::masterEndpoint()
+{
+    if (!isReplica())
+        return "";
+    std::lock_guard<std::mutex> lock(repl_mutex);
+    return master_host + ":" + std::to_string(master_port);
+}
+
+// Connect -> SYNC -> load snapshot -> apply the stream; reconnect with a
+// 1s backoff until the epoch moves on (REPLICAOF NO ONE or shutdown).
+void Replication::replicaLoop(uint64_t epoch)
+{
+    auto current = [&]
+    { return link_epoch.load(std::memory_order_acquire) == epoch; };
+
+    while (current())
+    {
+        std::string host;
+        int port;
+        {
+            std::lock_guard<std::mutex> lock(repl_mutex);
+            host = master_host;
+            port = master_port;
+        }
+
+        socket_t fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0)
+            break;
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons((uint16_t)port);
+        if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1)
+        {
+            Logger::getInstance().error("Bad master address: " + host);
+            ::close(fd);
+            return;
+        }
+
+        if (connect(fd, (sockaddr *)&addr, sizeof(addr)) < 0)
+        {
+            ::close(fd);
+            Logger::getInstance().warn("Master connect failed, retrying in 1s");
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            continue;
+        }
+
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        link_fd.store(fd, std::memory_order_release);
+
+        bool synced = false;
+        std::string inbuf;
+
+        if (sendAllFd(fd, "SYNC\r\n") && recvLine(fd, inbuf))
+        {
+            // "$<len>\r\n<snapshot bytes>\r\n"
+            size_t eol = inbuf.find('\n');
+            long long len = -1;
+            if (eol != std::string::npos && inbuf[0] == '$')
+            {
+                try
+                {
+                    len = std::stoll(inbuf.substr(1, eol - 1));
+                }
+                catch (...)
+                {
+                }
+            }
+
+            if (len >= 0)
+            {
+                inbuf.erase(0, eol + 1);
+                if (recvAtLeast(fd, inbuf, (size_t)len + 2))
+                {
+                    const std::string tmp = "repl-snapshot.my_rdb";
+                    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+                    out.write(inbuf.data(), (std::streamsize)len);
+                    out.close();
+                    inbuf.erase(0, (size_t)len + 2);
+
+                    synced = RedisDatabase::getInstance().load(tmp);
+                    std::remove(tmp.c_str());
+                }
+            }
+        }
+
+        if (!synced)
+        {
+            Logger::getInstance().warn("Initial sync failed, retrying in 1s");
+            link_fd.store(INVALID_SOCKET_T, std::memory_order_release);
+            ::close(fd);
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            continue;
+        }
+
+        Logger::getInstance().info("Initial sync complete, applying master stream");
+        link_up.store(true, std::memory_order_relaxed);
+
+        // Apply the ongoing command stream through a local handler
+        RedisCommandHandler handler;
+        tls_applying_stream = true;
+
+        while (current())
+        {
+            auto frames = handler.splitFrames(inbuf);
+            for (auto &f : frames)
+                handler.processCommand(f);
+
+            size_t have = inbuf.size();
+            if (!recvAtLeast(fd, inbuf, have + 1))
+                break;
+        }
+
+        tls_applying_stream = false;
+        link_up.store(false, std::memory_order_relaxed);
+        link_fd.store(INVALID_SOCKET_T, std::memory_order_release);
+        ::close(fd);
+
+        if (current())
+        {
+            Logger::getInstance().warn("Master link lost, reconnecting in 1s");
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+        }
+    }
+}
+
+/* =============================================================================
+                                  SHUTDOWN
+============================================================================= */
+void Replication::shutdown()
+{
+    stopReplication();
+
+    if (!master_running.exchange(false, std::memory_order_acq_rel))
+        return;
+
+    if (listen_fd != INVALID_SOCKET_T)
+    {
+        ::shutdown(listen_fd, SHUT_RDWR);
+        ::close(listen_fd);
+        listen_fd = INVALID_SOCKET_T;
+    }
+    if (accept_thread.joinable())
+        accept_thread.join();
+
+    std::lock_guard<std::mutex> lock(links_mutex);
+    for (auto &l : links)
+    {
+        l->attached.store(false, std::memory_order_release);
+        ::shutdown(l->fd, SHUT_RDWR);
+        l->cv.notify_one();
+        if (l->thread.joinable())
+            l->thread.join();
+    }
+    links.clear();
+    replica_count.store(0, std::memory_order_relaxed);
+}
+
+#else /* _WIN32: replication is POSIX-only, mirror the unixsocket policy */
+
+bool Replication::startMaster(int)
+{
+    Logger::getInstance().error("Replication is not supported on this platform");
+    return false;
+}
+
+void Replication::propagate(std::string_view) {}
+void Replication::replicaOf(const std::string &, int)
+{
+    Logger::getInstance().error("Replication is not supported on this platform");
+}
+void Replication::stopReplication() {}
+std::string Replication::masterEndpoint() { return ""; }
+void Replication::acceptLoop() {}
+void Replication::serveReplica(ReplicaLink *) {}
+void Replication::replicaLoop(uint64_t) {}
+void Replication::reapDeadLinks() {}
+void Replication::shutdown() {}
+
+#endif
@@ -0,0 +1,223 @@
+#include "../include/ServerStats.h"
+#include "../include/RedisDatabase.h"
+#include "../include/Replication.h"
+
+#include <sstream>
+
+/* ============================================================
+   SINGLETON
+   ============================================================ */
+ServerStats &ServerStats::getInstance()
+{
+    static ServerStats instance;
+    return instance;
+}
+
+ServerStats::ServerStats()
+    : start_time(std::chrono::steady_clock::now())
+{
+}
+
+/* ============================================================
+   COMMAND REGISTRATION (dispatch-table build time, not hot path)
+   ============================================================ */
+size_t ServerStats::registerCommand(std::string_view name)
+{
+    size_t n = slot_count.load(std::memory_order_acquire);
+    for (size_t i = 0; i < n; i++)
+        if (slots[i].name == name)
+            return i;
+
+    size_t slot = slot_count.fetch_add(1, std::memory_order_acq_rel);
+    if (slot >= MAX_COMMANDS)
+        return MAX_COMMANDS - 1; // overflow slot; never expected in practice
+
+    slots[slot].name.assign(name.data(), name.size());
+    return slot;
+}
+
+/* ============================================================
+   HOT-PATH RECORDING
+   ============================================================ */
+void ServerStats::recordCommand(size_t slot, uint64_t latency_us)
+{
+    if (slot >= MAX_COMMANDS)
+        return;
+
+    Stripe &s = slots[slot].stripes[stripeIndex()];
+    s.calls.fetch_add(1, std::memory_order_relaxed);
+    s.total_us.fetch_add(latency_us, std::memory_order_relaxed);
+
+    // log2 bucket: 0us and 1us both land in bucket 0
+    size_t b = 0;
+    while ((latency_us >> (b + 1)) != 0 && b + 1 < LAT_BUCKETS)
+        b++;
+    s.buckets[b].fetch_add(1, std::memory_order_relaxed);
+}
+
+void ServerStats::connectionOpened()
+{
+    connected_clients.fetch_add(1, std::memory_order_relaxed);
+    total_connections.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ServerStats::connectionClosed()
+{
+    connected_clients.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void ServerStats::addBytesIn(uint64_t n)
+{
+    io[stripeIndex()].bytes_in.fetch_add(n, std::memory_order_relaxed);
+}
+
+void ServerStats::addBytesOut(uint64_t n)
+{
+    io[stripeIndex()].bytes_out.fetch_add(n, std::memory_order_relaxed);
+}
+
+/* ============================================================
+   REPORTING
+   ============================================================ */
+namespace
+{
+    // Upper bound of histogram bucket i in microseconds
+    inline uint64_t bucketCeil(size_t i) { return 1ULL << (i + 1); }
+
+    // Approximate percentile from merged log2 buckets: returns the ceiling
+    // of the bucket where the cumulative count crosses p.
+    uint64_t percentileFromBuckets(const uint64_t *buckets, size_t nbuckets,
+                                   uint64_t total, double p)
+    {
+        if (total == 0)
+            return 0;
+
+        uint64_t target = (uint64_t)(p * total);
+        if (target == 0)
+            target = 1;
+
+        uint64_t cum = 0;
+        for (size_t i = 0; i < nbuckets; i++)
+        {
+            cum += buckets[i];
+            if (cum >= target)
+                return bucketCeil(i);
+        }
+        return bucketCeil(nbuckets - 1);
+    }
+}
+
+std::string ServerStats::render()
+{
+    std::ostringstream out;
+
+    auto uptime = std::chrono::duration_cast<std::chrono::seconds>(
+                      std::chrono::steady_clock::now() - start_time)
+                      .count();
+
+    /* ---------------- server / clients ---------------- */
+    out << "# Server\r\n"
+        << "uptime_seconds:" << uptime << "\r\n"
+        << "\r\n# Clients\r\n"
+        << "connected_clients:" << connected_clients.load(std::memory_order_relaxed) << "\r\n"
+        << "total_connections_received:" << total_connections.load(std::memory_order_relaxed) << "\r\n";
+
+    /* ---------------- network / totals ---------------- */
+    uint64_t in = 0, outb = 0;
+    for (size_t i = 0; i < STRIPES; i++)
+    {
+        in += io[i].bytes_in.load(std::memory_order_relaxed);
+        outb += io[i].bytes_out.load(std::memory_order_relaxed);
+    }
+
+    size_t ncmds = slot_count.load(std::memory_order_acquire);
+    if (ncmds > MAX_COMMANDS)
+        ncmds = MAX_COMMANDS;
+
+    uint64_t total_cmds = 0;
+    for (size_t c = 0; c < ncmds; c++)
+        for (size_t s = 0; s < STRIPES; s++)
+            total_cmds += slots[c].stripes[s].calls.load(std::memory_order_relaxed);
+
+    out << "\r\n# Stats\r\n"
+        << "total_commands_processed:" << total_cmds << "\r\n"
+        << "total_net_input_bytes:" << in << "\r\n"
+        << "total_net_output_bytes:" << outb << "\r\n"
+        << "negative_filter_enabled:"
+        << (RedisDatabase::getInstance().negativeFilterEnabled() ? 1 : 0) << "\r\n"
+        << "negative_filter_checks:" << RedisDatabase::getInstance().negFilterChecks() << "\r\n"
+        << "negative_filter_saved:" << RedisDatabase::getInstance().negFilterSaved() << "\r\n";
+
+    /* ---------------- keyspace ---------------- */
+    size_t kv = 0, lists = 0, hashes = 0;
+    RedisDatabase::getInstance().storeSizes(kv, lists, hashes);
+
+    out << "\r\n# Keyspace\r\n"
+        << "kv_keys:" << kv << "\r\n"
+        << "list_keys:" << lists << "\r\n"
+        << "hash_keys:" << hashes << "\r\n";
+
+    /* ---------------- memory ---------------- */
+    RedisDatabase &db = RedisDatabase::getInstance();
+
+    const char *policy = "noeviction";
+    switch (db.evictionPolicy())
+    {
+    case RedisDatabase::EvictionPolicy::AllkeysLru:
+        policy = "allkeys-lru";
+        break;
+    case RedisDatabase::EvictionPolicy::AllkeysRandom:
+        policy = "allkeys-random";
+        break;
+    default:
+        break;
+    }
+
+    out << "\r\n# Memory\r\n"
+        << "used_memory:" << db.memoryUsed() << "\r\n"
+        << "maxmemory:" << db.maxMemory() << "\r\n"
+        << "maxmemory_policy:" << policy << "\r\n"
+        << "evicted_keys:" << db.evictedKeys() << "\r\n";
+
+    /* ---------------- replication ---------------- */
+    Replication &repl = Replication::getInstance();
+
+    out << "\r\n# Replication\r\n"
+        << "role:" << (repl.isReplica() ? "slave" : "master") << "\r\n";
+
+    if (repl.isReplica())
+        out << "master_endpoint:" << repl.masterEndpoint() << "\r\n"
+            << "master_link_status:" << (repl.linkUp() ? "up" : "down") << "\r\n";
+    else
+        out << "connected_replicas:" << repl.replicaCount() << "\r\n";
+
+    /* ---------------- per-command stats ---------------- */
+    out << "\r\n# Commandstats\r\n";
+    for (size_t c = 0; c < ncmds; c++)
+    {
+        uint64_t calls = 0, usec = 0;
+        uint64_t merged[LAT_BUCKETS] = {};
+
+        for (size_t s = 0; s < STRIPES; s++)
+        {
+            Stripe &st = slots[c].stripes[s];
+            calls += st.calls.load(std::memory_order_relaxed);
+            usec += st.total_us.load(std::memory_order_relaxed);
+            for (size_t b = 0; b < LAT_BUCKETS; b++)
+                merged[b] += st.buckets[b].load(std::memory_order_relaxed);
+        }
+
+        if (calls == 0)
+            continue;
+
+        out << "cmdstat_" << slots[c].name
+            << ":calls=" << calls
+            << ",usec=" << usec
+            << ",usec_per_call=" << (usec / calls)
+            << ",p50=" << percentileFromBuckets(merged, LAT_BUCKETS, calls, 0.50)
+            << ",p99=" << percentileFromBuckets(merged, LAT_BUCKETS, calls, 0.99)
+            << "\r\n";
+    }
+
+    return out.str();
+}
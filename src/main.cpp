@@ -2,6 +2,9 @@
 
 #include "../include/RedisServer.h"
 #include "../include/RedisDatabase.h"
+#include "../include/RedisCommandHandler.h"
+#include "../include/AofLog.h"
+#include "../include/Replication.h"
 #include "../include/Logger.h"
 
 #include <thread>
@@ -87,19 +90,169 @@ int main(int argc, char *argv[])
         Logger::getInstance().info("Redis-like server starting...");
 
         int port = 6379;
-        if (argc >= 2)
+        RedisServer::IoMode io_mode = RedisServer::IoMode::Events;
+        int save_interval_sec = 300;
+        bool appendonly = false;
+        int acceptors = 1;
+        int backlog = 128;
+        std::string unixsocket; // empty = TCP only
+        size_t maxmemory = 0;   // 0 = unlimited
+        bool negative_filter = false;
+        int repl_port = 0;      // 0 = no replication listener
+        std::string replicaof;  // "host:port" = start as a replica
+        RedisDatabase::EvictionPolicy policy = RedisDatabase::EvictionPolicy::AllkeysLru;
+
+        // "100mb" / "2gb" / plain bytes
+        auto parseMemory = [](const std::string &v) -> size_t
         {
-            try
+            size_t pos = 0;
+            size_t n = (size_t)std::stoull(v, &pos);
+            std::string unit = v.substr(pos);
+            if (unit == "kb" || unit == "KB")
+                return n * 1024;
+            if (unit == "mb" || unit == "MB")
+                return n * 1024 * 1024;
+            if (unit == "gb" || unit == "GB")
+                return n * 1024 * 1024 * 1024;
+            if (!unit.empty())
+                throw std::invalid_argument("bad memory unit");
+            return n;
+        };
+
+        for (int i = 1; i < argc; i++)
+        {
+            std::string arg = argv[i];
+
+            if (arg == "--io-mode=threads")
             {
-                port = std::stoi(argv[1]);
+                io_mode = RedisServer::IoMode::Threads;
             }
-            catch (...)
+            else if (arg == "--io-mode=events")
+            {
+                io_mode = RedisServer::IoMode::Events;
+            }
+            else if (arg == "--io-mode=uring")
+            {
+                io_mode = RedisServer::IoMode::Uring;
+            }
+            else if (arg == "--appendonly")
+            {
+                appendonly = true;
+            }
+            else if (arg.rfind("--save-interval=", 0) == 0)
+            {
+                try
+                {
+                    save_interval_sec = std::stoi(arg.substr(16));
+                }
+                catch (...)
+                {
+                    Logger::getInstance().warn("Invalid --save-interval, using default 300s");
+                }
+            }
+            else if (arg.rfind("--acceptors=", 0) == 0)
+            {
+                try
+                {
+                    acceptors = std::stoi(arg.substr(12));
+                }
+                catch (...)
+                {
+                    Logger::getInstance().warn("Invalid --acceptors, using default 1");
+                }
+            }
+            else if (arg.rfind("--backlog=", 0) == 0)
             {
-                Logger::getInstance().warn("Invalid port argument, using default 6379");
-                port = 6379;
+                try
+                {
+                    backlog = std::stoi(arg.substr(10));
+                }
+                catch (...)
+                {
+                    Logger::getInstance().warn("Invalid --backlog, using default 128");
+                }
+            }
+            else if (arg.rfind("--unixsocket=", 0) == 0)
+            {
+                unixsocket = arg.substr(13);
+                if (unixsocket.empty())
+                    Logger::getInstance().warn("Empty --unixsocket path, ignoring");
+            }
+            else if (arg == "--negative-filter")
+            {
+                negative_filter = true;
+            }
+            else if (arg.rfind("--repl-port=", 0) == 0)
+            {
+                try
+                {
+                    repl_port = std::stoi(arg.substr(12));
+                }
+                catch (...)
+                {
+                    Logger::getInstance().warn("Invalid --repl-port, replication disabled");
+                }
+            }
+            else if (arg.rfind("--replicaof=", 0) == 0)
+            {
+                replicaof = arg.substr(12);
+                if (replicaof.find(':') == std::string::npos)
+                {
+                    Logger::getInstance().warn("--replicaof expects host:port, ignoring");
+                    replicaof.clear();
+                }
+            }
+            else if (arg.rfind("--maxmemory=", 0) == 0)
+            {
+                try
+                {
+                    maxmemory = parseMemory(arg.substr(12));
+                }
+                catch (...)
+                {
+                    Logger::getInstance().warn("Invalid --maxmemory, leaving unlimited");
+                }
+            }
+            else if (arg.rfind("--maxmemory-policy=", 0) == 0)
+            {
+                std::string p = arg.substr(19);
+                if (p == "allkeys-lru")
+                    policy = RedisDatabase::EvictionPolicy::AllkeysLru;
+                else if (p == "allkeys-random")
+                    policy = RedisDatabase::EvictionPolicy::AllkeysRandom;
+                else if (p == "noeviction")
+                    policy = RedisDatabase::EvictionPolicy::NoEviction;
+                else
+                    Logger::getInstance().warn("Unknown --maxmemory-policy '" + p +
+                                               "', using allkeys-lru");
+            }
+            else
+            {
+                try
+                {
+                    port = std::stoi(arg);
+                }
+                catch (...)
+                {
+                    Logger::getInstance().warn("Unrecognized argument '" + arg + "', ignoring");
+                }
             }
         }
 
+        // ----------------------------------------------------------
+        // Memory limit (configure before any data is loaded/served)
+        // ----------------------------------------------------------
+        if (maxmemory > 0)
+        {
+            RedisDatabase::getInstance().setMaxMemory(maxmemory);
+            RedisDatabase::getInstance().setEvictionPolicy(policy);
+            Logger::getInstance().info("maxmemory set to " + std::to_string(maxmemory) + " bytes");
+        }
+
+        // Enable before the load so the loaders seed it as they insert
+        if (negative_filter)
+            RedisDatabase::getInstance().enableNegativeFilter();
+
         // ----------------------------------------------------------
         // Load DB on startup
         // ----------------------------------------------------------
@@ -114,10 +267,44 @@ int main(int argc, char *argv[])
             Logger::getInstance().info("Empty DB initialized");
         }
 
+        // ----------------------------------------------------------
+        // AOF: replay on top of the snapshot, then start logging
+        // ----------------------------------------------------------
+        if (appendonly)
+        {
+            RedisCommandHandler replayHandler;
+            if (AofLog::replay("appendonly.aof", replayHandler))
+                std::cout << "AOF replayed from appendonly.aof\n";
+
+            if (!AofLog::getInstance().enable("appendonly.aof"))
+                Logger::getInstance().error("Failed to enable AOF, continuing without it");
+        }
+
+        // ----------------------------------------------------------
+        // Replication: open the master-side listener and/or attach to
+        // a master, after the local dataset is in place
+        // ----------------------------------------------------------
+        if (repl_port > 0 && !Replication::getInstance().startMaster(repl_port))
+            Logger::getInstance().error("Replication listener failed, continuing without it");
+
+        if (!replicaof.empty())
+        {
+            size_t colon = replicaof.rfind(':');
+            try
+            {
+                int mport = std::stoi(replicaof.substr(colon + 1));
+                Replication::getInstance().replicaOf(replicaof.substr(0, colon), mport);
+            }
+            catch (...)
+            {
+                Logger::getInstance().warn("Invalid --replicaof port, staying a master");
+            }
+        }
+
         // ----------------------------------------------------------
         // Start server
         // ----------------------------------------------------------
-        RedisServer server(port);
+        RedisServer server(port, io_mode, acceptors, backlog, unixsocket);
         Logger::getInstance().info("Server initialized on port " + std::to_string(port));
 
 #ifndef _WIN32
@@ -127,13 +314,14 @@ int main(int argc, char *argv[])
 #endif
 
         // ----------------------------------------------------------
-        // Persistence Thread (every 300s)
+        // Persistence Thread (periodic background snapshot)
         // ----------------------------------------------------------
-        constexpr std::chrono::seconds INTERVAL(300);
+        const std::chrono::seconds INTERVAL(save_interval_sec);
 
         std::thread persistenceThread([&]()
                                       {
-            Logger::getInstance().info("Persistence worker started (300s interval)");
+            Logger::getInstance().info("Persistence worker started (" +
+                                       std::to_string(save_interval_sec) + "s interval)");
 
             while (persistRunning.load(std::memory_order_relaxed))
             {
@@ -148,7 +336,10 @@ int main(int argc, char *argv[])
                 if (!persistRunning.load(std::memory_order_relaxed))
                     break;
 
-                safeDump("dump.my_rdb");
+                // Non-blocking: COW fork (or snapshot thread) — never
+                // stalls clients, unlike a foreground dump()
+                if (!RedisDatabase::getInstance().bgsave("dump.my_rdb"))
+                    Logger::getInstance().warn("Periodic save skipped (save already running)");
             }
 
             Logger::getInstance().info("Persistence worker exiting"); });
@@ -171,8 +362,11 @@ int main(int argc, char *argv[])
         if (persistenceThread.joinable())
             persistenceThread.join();
 
+        Replication::getInstance().shutdown();
+
         Logger::getInstance().info("Performing final DB dump...");
         safeDump("dump.my_rdb");
+        AofLog::getInstance().shutdown();
 
         Logger::getInstance().info("Shutdown complete");
         Logger::getInstance().shutdown();
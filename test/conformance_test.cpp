@@ -0,0 +1,526 @@
+// test/conformance_test.cpp — FlashKv protocol + regression gate (make test)
+//
+// Spawns a server instance in a scratch directory, then drives it over
+// TCP through three suites:
+//
+//   1. RESP conformance — frames fragmented at every byte boundary,
+//      byte-at-a-time streaming, pipelined batches, inline commands,
+//      and rejection of a bulk that claims more than the 512 MB cap.
+//   2. Concurrency — N threads hammering INCR on one key and LPUSH on
+//      one list must land exactly the expected totals.
+//   3. Throughput smoke — a fixed-duration pipelined GET/SET run whose
+//      ops/sec is compared against test/throughput_baseline.txt; a drop
+//      below REGRESSION_FRACTION of the recorded number fails the run.
+//      A missing baseline is recorded rather than failed, so the first
+//      run on a new box seeds it.
+//
+//   ./conformance [--server=PATH] [--port=N] [--baseline=FILE]
+//
+// Exit code 0 = all suites passed (the make target relies on this).
+
+#include <iostream>
+#include <fstream>
+#include <filesystem>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+#ifdef _WIN32
+#include <winsock2.h>
+int main()
+{
+    std::cerr << "conformance runner is POSIX-only (needs fork/exec)\n";
+    return 1;
+}
+#else
+
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <unistd.h>
+#include <csignal>
+
+// ====================================================
+// RESP helpers
+// ====================================================
+static std::string buildRESP(const std::vector<std::string> &parts)
+{
+    std::ostringstream oss;
+    oss << "*" << parts.size() << "\r\n";
+    for (auto &p : parts)
+        oss << "$" << p.size() << "\r\n"
+            << p << "\r\n";
+    return oss.str();
+}
+
+// Consume exactly one RESP reply from buf starting at pos; returns false
+// when more bytes are needed. Nested arrays recurse.
+static bool consumeReply(const std::string &buf, size_t &pos)
+{
+    if (pos >= buf.size())
+        return false;
+
+    char t = buf[pos];
+    size_t nl = buf.find("\r\n", pos);
+    if (nl == std::string::npos)
+        return false;
+
+    if (t == '+' || t == '-' || t == ':')
+    {
+        pos = nl + 2;
+        return true;
+    }
+    if (t == '$')
+    {
+        long long len = std::atoll(buf.c_str() + pos + 1);
+        if (len < 0)
+        {
+            pos = nl + 2; // nil bulk
+            return true;
+        }
+        size_t end = nl + 2 + (size_t)len + 2;
+        if (buf.size() < end)
+            return false;
+        pos = end;
+        return true;
+    }
+    if (t == '*')
+    {
+        long long n = std::atoll(buf.c_str() + pos + 1);
+        size_t p = nl + 2;
+        for (long long i = 0; i < n; i++)
+            if (!consumeReply(buf, p))
+                return false;
+        pos = p;
+        return true;
+    }
+    return false; // unknown type byte: treat as protocol failure
+}
+
+// ====================================================
+// Socket plumbing
+// ====================================================
+static int g_port = 7390;
+
+static int connectServer()
+{
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0)
+        return -1;
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)g_port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+
+    if (connect(fd, (sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        close(fd);
+        return -1;
+    }
+
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+static bool sendAll(int fd, const char *data, size_t len)
+{
+    size_t off = 0;
+    while (off < len)
+    {
+        ssize_t n = send(fd, data + off, len - off, MSG_NOSIGNAL);
+        if (n < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        off += (size_t)n;
+    }
+    return true;
+}
+
+// Read until `count` complete replies have arrived; returns them raw.
+// Empty result = connection closed or timed out first.
+static std::string readReplies(int fd, size_t count, int timeout_ms = 5000)
+{
+    std::string buf;
+    size_t done = 0, pos = 0;
+    char chunk[65536];
+
+    timeval tv{timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    while (done < count)
+    {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0)
+            return {};
+        buf.append(chunk, (size_t)n);
+
+        while (done < count && consumeReply(buf, pos))
+            done++;
+    }
+    return buf;
+}
+
+static std::string roundtrip(int fd, const std::vector<std::string> &cmd)
+{
+    std::string frame = buildRESP(cmd);
+    if (!sendAll(fd, frame.data(), frame.size()))
+        return {};
+    return readReplies(fd, 1);
+}
+
+// ====================================================
+// Check bookkeeping
+// ====================================================
+static int g_failures = 0;
+
+static void check(bool ok, const std::string &what)
+{
+    if (ok)
+    {
+        std::cout << "  ok  " << what << "\n";
+    }
+    else
+    {
+        std::cout << "  FAIL " << what << "\n";
+        g_failures++;
+    }
+}
+
+// ====================================================
+// Suite 1: RESP conformance
+// ====================================================
+static void respSuite()
+{
+    std::cout << "== RESP conformance ==\n";
+
+    int fd = connectServer();
+    check(fd >= 0, "connect");
+    if (fd < 0)
+        return;
+
+    check(roundtrip(fd, {"PING"}) == "+PONG\r\n", "PING");
+    check(roundtrip(fd, {"SET", "conf:k", "v1"}) == "+OK\r\n", "SET");
+    check(roundtrip(fd, {"GET", "conf:k"}) == "$2\r\nv1\r\n", "GET");
+
+    // Fragmented frames: the same SET split at every byte boundary must
+    // parse identically — this is exactly what has silently broken before.
+    {
+        std::string frame = buildRESP({"SET", "conf:frag", "fragval"});
+        bool all = true;
+        for (size_t cut = 1; cut < frame.size() && all; cut++)
+        {
+            sendAll(fd, frame.data(), cut);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            sendAll(fd, frame.data() + cut, frame.size() - cut);
+            all = readReplies(fd, 1) == "+OK\r\n";
+        }
+        check(all, "frame split at every byte boundary");
+    }
+
+    // Byte-at-a-time streaming of one frame
+    {
+        std::string frame = buildRESP({"GET", "conf:frag"});
+        for (char c : frame)
+        {
+            sendAll(fd, &c, 1);
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        check(readReplies(fd, 1) == "$7\r\nfragval\r\n", "byte-at-a-time frame");
+    }
+
+    // Pipelined batch: every command in one write gets exactly one reply
+    {
+        const size_t N = 500;
+        std::string batch;
+        for (size_t i = 0; i < N; i++)
+            batch += buildRESP({"SET", "conf:p" + std::to_string(i), "x"});
+        sendAll(fd, batch.data(), batch.size());
+        check(!readReplies(fd, N).empty(), "pipelined batch of 500");
+    }
+
+    // Inline commands share the dispatch path with RESP arrays
+    {
+        const char *inl = "PING\r\n";
+        sendAll(fd, inl, strlen(inl));
+        check(readReplies(fd, 1) == "+PONG\r\n", "inline PING");
+
+        const char *inl2 = "SET conf:inline inlineval\r\n";
+        sendAll(fd, inl2, strlen(inl2));
+        check(readReplies(fd, 1) == "+OK\r\n", "inline SET");
+        check(roundtrip(fd, {"GET", "conf:inline"}) == "$9\r\ninlineval\r\n",
+              "inline SET visible via RESP GET");
+    }
+
+    close(fd);
+
+    // Oversized bulk: a header past the 512 MB cap must never be
+    // swallowed — the connection is errored/closed once the declared
+    // payload streams in, not buffered without bound.
+    {
+        int fd2 = connectServer();
+        const char *hdr = "*2\r\n$3\r\nGET\r\n$600000000\r\n";
+        sendAll(fd2, hdr, strlen(hdr));
+
+        std::string filler(1 << 20, 'x');
+        bool rejected = false;
+        for (int i = 0; i < 8 && !rejected; i++) // 8 MB > the 4 MB buffer cap
+            if (!sendAll(fd2, filler.data(), filler.size()))
+                rejected = true;
+
+        if (!rejected)
+        {
+            std::string r = readReplies(fd2, 1, 2000);
+            rejected = r.empty() || r[0] == '-';
+        }
+        check(rejected, "oversized bulk (600 MB declared) rejected");
+        close(fd2);
+    }
+}
+
+// ====================================================
+// Suite 2: concurrent-client consistency
+// ====================================================
+static void concurrencySuite()
+{
+    std::cout << "== concurrency ==\n";
+
+    const int THREADS = 8;
+    const int OPS = 2000;
+    const int BATCH = 500; // stay under the per-wakeup frame cap
+
+    // INCR: THREADS*OPS increments must land exactly
+    {
+        std::vector<std::thread> ts;
+        std::atomic<int> errors{0};
+        for (int t = 0; t < THREADS; t++)
+            ts.emplace_back([&]()
+                            {
+                int fd = connectServer();
+                if (fd < 0) { errors++; return; }
+                std::string frame = buildRESP({"INCR", "conf:ctr"});
+                for (int done = 0; done < OPS; done += BATCH)
+                {
+                    std::string batch;
+                    for (int i = 0; i < BATCH; i++)
+                        batch += frame;
+                    if (!sendAll(fd, batch.data(), batch.size()) ||
+                        readReplies(fd, BATCH).empty())
+                    {
+                        errors++;
+                        break;
+                    }
+                }
+                close(fd); });
+        for (auto &t : ts)
+            t.join();
+
+        int fd = connectServer();
+        std::string got = roundtrip(fd, {"INCR", "conf:ctr"});
+        std::string expect = ":" + std::to_string(THREADS * OPS + 1) + "\r\n";
+        check(errors == 0 && got == expect,
+              "concurrent INCR (" + std::to_string(THREADS * OPS) + " ops, got " + got.substr(0, got.size() > 2 ? got.size() - 2 : 0) + ")");
+        close(fd);
+    }
+
+    // LPUSH: total list length must equal the pushes issued
+    {
+        std::vector<std::thread> ts;
+        std::atomic<int> errors{0};
+        for (int t = 0; t < THREADS; t++)
+            ts.emplace_back([&, t]()
+                            {
+                int fd = connectServer();
+                if (fd < 0) { errors++; return; }
+                for (int done = 0; done < OPS; done += BATCH)
+                {
+                    std::string batch;
+                    for (int i = 0; i < BATCH; i++)
+                        batch += buildRESP({"LPUSH", "conf:list",
+                                            std::to_string(t) + ":" + std::to_string(done + i)});
+                    if (!sendAll(fd, batch.data(), batch.size()) ||
+                        readReplies(fd, BATCH).empty())
+                    {
+                        errors++;
+                        break;
+                    }
+                }
+                close(fd); });
+        for (auto &t : ts)
+            t.join();
+
+        int fd = connectServer();
+        std::string r = roundtrip(fd, {"LRANGE", "conf:list", "0", "-1"});
+        long long n = r.size() > 1 ? std::atoll(r.c_str() + 1) : -1;
+        check(errors == 0 && n == THREADS * OPS,
+              "concurrent LPUSH (length " + std::to_string(n) + ")");
+        close(fd);
+    }
+}
+
+// ====================================================
+// Suite 3: throughput regression smoke
+// ====================================================
+static void throughputSuite(const std::string &baseline_path)
+{
+    std::cout << "== throughput smoke ==\n";
+
+    // A generous margin: this gate exists to catch order-of-magnitude
+    // slides (accidental O(n) in the hot path, a lock left exclusive),
+    // not single-digit noise on shared CI hardware.
+    const double REGRESSION_FRACTION = 0.5;
+    const int DURATION_MS = 2000;
+    const int CLIENTS = 4;
+    const int PIPELINE = 100;
+
+    std::atomic<uint64_t> total_ops{0};
+    std::atomic<bool> stop{false};
+
+    std::vector<std::thread> ts;
+    for (int c = 0; c < CLIENTS; c++)
+        ts.emplace_back([&, c]()
+                        {
+            int fd = connectServer();
+            if (fd < 0)
+                return;
+
+            std::string batch;
+            for (int i = 0; i < PIPELINE; i++)
+            {
+                std::string key = "perf:" + std::to_string(c) + ":" + std::to_string(i % 64);
+                if (i % 4 == 0)
+                    batch += buildRESP({"SET", key, "0123456789abcdef"});
+                else
+                    batch += buildRESP({"GET", key});
+            }
+
+            uint64_t ops = 0;
+            while (!stop.load(std::memory_order_relaxed))
+            {
+                if (!sendAll(fd, batch.data(), batch.size()) ||
+                    readReplies(fd, PIPELINE).empty())
+                    break;
+                ops += PIPELINE;
+            }
+            total_ops.fetch_add(ops, std::memory_order_relaxed);
+            close(fd); });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(DURATION_MS));
+    stop.store(true);
+    for (auto &t : ts)
+        t.join();
+
+    double ops_sec = total_ops.load() * 1000.0 / DURATION_MS;
+    std::cout << "  measured " << (uint64_t)ops_sec << " ops/sec\n";
+
+    std::ifstream in(baseline_path);
+    double baseline = 0;
+    if (in >> baseline && baseline > 0)
+    {
+        double floor = baseline * REGRESSION_FRACTION;
+        check(ops_sec >= floor,
+              "throughput vs baseline " + std::to_string((uint64_t)baseline) +
+                  " (floor " + std::to_string((uint64_t)floor) + ")");
+    }
+    else
+    {
+        std::ofstream out(baseline_path, std::ios::trunc);
+        out << (uint64_t)ops_sec << "\n";
+        std::cout << "  ok  recorded new baseline " << (uint64_t)ops_sec
+                  << " ops/sec -> " << baseline_path << "\n";
+    }
+}
+
+// ====================================================
+// Server lifecycle + main
+// ====================================================
+int main(int argc, char *argv[])
+{
+    std::string server = "./my_redis_server";
+    std::string baseline = "test/throughput_baseline.txt";
+
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg.rfind("--server=", 0) == 0)
+            server = arg.substr(9);
+        else if (arg.rfind("--port=", 0) == 0)
+            g_port = std::atoi(arg.c_str() + 7);
+        else if (arg.rfind("--baseline=", 0) == 0)
+            baseline = arg.substr(11);
+    }
+
+    // Spawn the server in a scratch dir so its dump/logs don't land in
+    // the source tree, and it never loads a stale dataset.
+    std::string abs_server = std::filesystem::absolute(server).string();
+    char tmpl[] = "/tmp/flashkv-test-XXXXXX";
+    char *scratch = mkdtemp(tmpl);
+    if (!scratch)
+    {
+        std::cerr << "mkdtemp failed\n";
+        return 1;
+    }
+
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        if (chdir(scratch) != 0)
+            _exit(127);
+        execl(abs_server.c_str(), abs_server.c_str(),
+              std::to_string(g_port).c_str(), (char *)nullptr);
+        _exit(127);
+    }
+
+    // Wait for the listener (up to ~5s)
+    bool up = false;
+    for (int i = 0; i < 500 && !up; i++)
+    {
+        int fd = connectServer();
+        if (fd >= 0)
+        {
+            up = true;
+            close(fd);
+        }
+        else
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    if (!up)
+    {
+        std::cerr << "server did not come up on port " << g_port << "\n";
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+        return 1;
+    }
+
+    respSuite();
+    concurrencySuite();
+    throughputSuite(baseline);
+
+    kill(pid, SIGTERM);
+    waitpid(pid, nullptr, 0);
+    std::filesystem::remove_all(scratch);
+
+    if (g_failures == 0)
+    {
+        std::cout << "all checks passed\n";
+        return 0;
+    }
+    std::cout << g_failures << " check(s) FAILED\n";
+    return 1;
+}
+
+#endif // _WIN32
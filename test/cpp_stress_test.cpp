@@ -1,12 +1,34 @@
+// test/cpp_stress_test.cpp — FlashKv benchmark harness
+//
+// Drives a running server over TCP with a configurable command mix,
+// key-space size, value-size range, pipelining depth and warmup phase,
+// and reports throughput plus latency percentiles (p50/p99/p99.9/max).
+// Results can be appended to a CSV for regression tracking across builds.
+//
+//   ./bench [options]
+//     --host=IP            server address      (default 127.0.0.1)
+//     --port=N             server port         (default 6379)
+//     --clients=N          client threads      (default 50)
+//     --ops=N              ops per client      (default 10000)
+//     --pipeline=N         commands per batch  (default 1)
+//     --keys=N             key-space size      (default 10000)
+//     --valsize=MIN[:MAX]  value bytes         (default 64)
+//     --mix=get:70,set:20,lpush:5,hset:5       command ratios
+//     --warmup=N           unrecorded ops per client (default 1000)
+//     --csv=FILE           append a result row to FILE
+
 #include <iostream>
+#include <fstream>
 #include <vector>
 #include <thread>
 #include <atomic>
 #include <chrono>
 #include <cstring>
 #include <sstream>
+#include <algorithm>
 #include <mutex>
 #include <random>
+#include <string>
 
 #ifdef _WIN32
 #include <winsock2.h>
@@ -16,6 +38,8 @@
 #else
 #include <sys/socket.h>
 #include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <unistd.h>
 #define CLOSE_SOCKET close
 #endif
@@ -36,87 +60,201 @@ std::string buildRESP(const std::vector<std::string> &parts)
 }
 
 // ====================================================
-// Single Client Worker
+// RESP reply skipper: returns the end offset of one complete
+// reply starting at pos, or npos if the buffer is incomplete.
+// Used to count how many pipelined replies have arrived.
 // ====================================================
-struct Stats
+static size_t skipReply(const std::string &b, size_t pos)
+{
+    if (pos >= b.size())
+        return std::string::npos;
+
+    char t = b[pos];
+    size_t rn = b.find("\r\n", pos + 1);
+    if (rn == std::string::npos)
+        return std::string::npos;
+
+    switch (t)
+    {
+    case '+':
+    case '-':
+    case ':':
+        return rn + 2;
+
+    case '$':
+    {
+        long len = std::stol(b.substr(pos + 1, rn - pos - 1));
+        if (len < 0)
+            return rn + 2; // nil bulk
+        size_t end = rn + 2 + (size_t)len + 2;
+        return (end <= b.size()) ? end : std::string::npos;
+    }
+
+    case '*':
+    {
+        long n = std::stol(b.substr(pos + 1, rn - pos - 1));
+        size_t p = rn + 2;
+        for (long i = 0; i < n; i++)
+        {
+            p = skipReply(b, p);
+            if (p == std::string::npos)
+                return std::string::npos;
+        }
+        return p;
+    }
+
+    default:
+        // inline garbage: treat the line as one reply
+        return rn + 2;
+    }
+}
+
+// ====================================================
+// Config & per-thread results
+// ====================================================
+struct Config
+{
+    std::string host = "127.0.0.1";
+    int port = 6379;
+    int clients = 50;
+    int ops = 10000;
+    int pipeline = 1;
+    int keyspace = 10000;
+    int valsize_min = 64;
+    int valsize_max = 64;
+    int warmup = 1000;
+    std::string csv;
+
+    // cumulative command weights out of the total
+    int w_get = 70, w_set = 20, w_lpush = 5, w_hset = 5;
+};
+
+struct WorkerResult
 {
-    std::atomic<long long> totalOps = 0;
-    std::atomic<long long> totalLatencyMicro = 0;
-    std::atomic<int> timeouts = 0;
-    std::atomic<int> failures = 0;
+    long long ops_done = 0;
+    std::vector<uint64_t> latencies_us; // one sample per pipelined batch
+    bool failed = false;
 };
 
-void clientWorker(int id, const std::string &host, int port,
-                  int ops, const std::string &mode, Stats *stats)
+// ====================================================
+// Single Client Worker
+// ====================================================
+static void clientWorker(int id, const Config &cfg, WorkerResult *res)
 {
 #ifdef _WIN32
     WSADATA wsa;
     WSAStartup(MAKEWORD(2, 2), &wsa);
 #endif
 
-    // Create socket
     int sock = socket(AF_INET, SOCK_STREAM, 0);
     if (sock < 0)
     {
-        stats->failures++;
+        res->failed = true;
         return;
     }
 
     sockaddr_in server{};
     server.sin_family = AF_INET;
-    server.sin_port = htons(port);
-    server.sin_addr.s_addr = inet_addr(host.c_str());
+    server.sin_port = htons(cfg.port);
+    server.sin_addr.s_addr = inet_addr(cfg.host.c_str());
 
     if (connect(sock, (sockaddr *)&server, sizeof(server)) < 0)
     {
-        stats->failures++;
+        res->failed = true;
         CLOSE_SOCKET(sock);
         return;
     }
 
-    char buffer[2048];
+    {
+        int flag = 1;
+        setsockopt(sock, IPPROTO_TCP, TCP_NODELAY, (char *)&flag, sizeof(flag));
+    }
 
-    for (int i = 0; i < ops; i++)
+    std::mt19937 rng((unsigned)(id * 2654435761u));
+    std::uniform_int_distribution<int> key_dist(0, cfg.keyspace - 1);
+    std::uniform_int_distribution<int> val_dist(cfg.valsize_min, cfg.valsize_max);
+    std::uniform_int_distribution<int> mix_dist(0, cfg.w_get + cfg.w_set + cfg.w_lpush + cfg.w_hset - 1);
+
+    const std::string val_pool(cfg.valsize_max > 0 ? cfg.valsize_max : 1, 'x');
+
+    auto makeCommand = [&]() -> std::string
     {
-        std::string cmd;
-        if (mode == "ping")
-        {
-            cmd = buildRESP({"PING"});
-        }
-        else if (mode == "sets")
+        std::string key = "bench_" + std::to_string(key_dist(rng));
+        int roll = mix_dist(rng);
+
+        if (roll < cfg.w_get)
+            return buildRESP({"GET", key});
+        roll -= cfg.w_get;
+
+        if (roll < cfg.w_set)
+            return buildRESP({"SET", key, val_pool.substr(0, val_dist(rng))});
+        roll -= cfg.w_set;
+
+        if (roll < cfg.w_lpush)
+            return buildRESP({"LPUSH", "benchlist_" + std::to_string(key_dist(rng) % 64),
+                              val_pool.substr(0, val_dist(rng))});
+
+        return buildRESP({"HSET", "benchhash_" + std::to_string(key_dist(rng) % 1024),
+                          "f" + std::to_string(key_dist(rng) % 16),
+                          val_pool.substr(0, val_dist(rng))});
+    };
+
+    char buffer[64 * 1024];
+    std::string inbuf;
+    std::string batch;
+
+    int total = cfg.warmup + cfg.ops;
+    res->latencies_us.reserve((cfg.ops + cfg.pipeline - 1) / cfg.pipeline);
+
+    for (int done = 0; done < total;)
+    {
+        int n = std::min(cfg.pipeline, total - done);
+
+        batch.clear();
+        for (int i = 0; i < n; i++)
+            batch += makeCommand();
+
+        auto t0 = std::chrono::steady_clock::now();
+
+        if (send(sock, batch.data(), batch.size(), 0) <= 0)
         {
-            cmd = buildRESP({"SET", "key_" + std::to_string(id) + "_" + std::to_string(i), "value123"});
+            res->failed = true;
+            break;
         }
-        else if (mode == "gets")
+
+        // read until n complete replies have arrived
+        inbuf.clear();
+        int replies = 0;
+        size_t pos = 0;
+        while (replies < n)
         {
-            cmd = buildRESP({"GET", "key_" + std::to_string(id) + "_" + std::to_string(i)});
-        }
-        else
-        { // mixed set/get
-            bool isSet = (i % 2 == 0);
-            std::string key = "mkey_" + std::to_string(id) + "_" + std::to_string(i % 200);
-
-            if (isSet)
-                cmd = buildRESP({"SET", key, "valueXYZ"});
-            else
-                cmd = buildRESP({"GET", key});
-        }
+            int got = recv(sock, buffer, sizeof(buffer), 0);
+            if (got <= 0)
+            {
+                res->failed = true;
+                break;
+            }
+            inbuf.append(buffer, got);
 
-        auto t0 = std::chrono::high_resolution_clock::now();
-        send(sock, cmd.c_str(), cmd.size(), 0);
+            size_t next;
+            while (replies < n && (next = skipReply(inbuf, pos)) != std::string::npos)
+            {
+                pos = next;
+                replies++;
+            }
+        }
+        if (res->failed)
+            break;
 
-        int n = recv(sock, buffer, sizeof(buffer), 0);
-        auto t1 = std::chrono::high_resolution_clock::now();
+        auto t1 = std::chrono::steady_clock::now();
 
-        if (n <= 0)
+        done += n;
+        if (done > cfg.warmup) // skip samples from the warmup phase
         {
-            stats->timeouts++;
-            continue;
+            res->latencies_us.push_back(
+                std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count());
+            res->ops_done += n;
         }
-
-        long long us = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
-        stats->totalLatencyMicro += us;
-        stats->totalOps++;
     }
 
     CLOSE_SOCKET(sock);
@@ -127,60 +265,157 @@ void clientWorker(int id, const std::string &host, int port,
 }
 
 // ====================================================
-// MAIN – Stress Test Controller
+// Percentile over a sorted sample vector
+// ====================================================
+static uint64_t percentile(const std::vector<uint64_t> &sorted, double p)
+{
+    if (sorted.empty())
+        return 0;
+    size_t idx = (size_t)(p * (sorted.size() - 1));
+    return sorted[idx];
+}
+
+// ====================================================
+// MAIN – Benchmark Controller
 // ====================================================
 int main(int argc, char *argv[])
 {
-    // Config
-    std::string host = "127.0.0.1";
-    int port = 6379;
-    int clients = 50;
-    int ops = 200;
-    std::string mode = "setget";
-
-    if (argc >= 2)
-        clients = std::stoi(argv[1]);
-    if (argc >= 3)
-        ops = std::stoi(argv[2]);
-    if (argc >= 4)
-        mode = argv[3];
-
-    std::cout << "=== C++ Redis Stress Tester ===\n";
-    std::cout << "Clients: " << clients << "\n";
-    std::cout << "Ops/client: " << ops << "\n";
-    std::cout << "Mode: " << mode << "\n\n";
-
-    Stats stats;
-    std::vector<std::thread> threads;
+    Config cfg;
 
-    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        auto val = [&](size_t prefix)
+        { return arg.substr(prefix); };
 
-    for (int i = 0; i < clients; i++)
+        if (arg.rfind("--host=", 0) == 0)
+            cfg.host = val(7);
+        else if (arg.rfind("--port=", 0) == 0)
+            cfg.port = std::stoi(val(7));
+        else if (arg.rfind("--clients=", 0) == 0)
+            cfg.clients = std::stoi(val(10));
+        else if (arg.rfind("--ops=", 0) == 0)
+            cfg.ops = std::stoi(val(6));
+        else if (arg.rfind("--pipeline=", 0) == 0)
+            cfg.pipeline = std::max(1, std::stoi(val(11)));
+        else if (arg.rfind("--keys=", 0) == 0)
+            cfg.keyspace = std::max(1, std::stoi(val(7)));
+        else if (arg.rfind("--warmup=", 0) == 0)
+            cfg.warmup = std::stoi(val(9));
+        else if (arg.rfind("--csv=", 0) == 0)
+            cfg.csv = val(6);
+        else if (arg.rfind("--valsize=", 0) == 0)
+        {
+            std::string v = val(10);
+            size_t colon = v.find(':');
+            cfg.valsize_min = std::stoi(v.substr(0, colon));
+            cfg.valsize_max = (colon == std::string::npos)
+                                  ? cfg.valsize_min
+                                  : std::stoi(v.substr(colon + 1));
+        }
+        else if (arg.rfind("--mix=", 0) == 0)
+        {
+            cfg.w_get = cfg.w_set = cfg.w_lpush = cfg.w_hset = 0;
+            std::stringstream ss{val(6)};
+            std::string part;
+            while (std::getline(ss, part, ','))
+            {
+                size_t colon = part.find(':');
+                if (colon == std::string::npos)
+                    continue;
+                std::string name = part.substr(0, colon);
+                int w = std::stoi(part.substr(colon + 1));
+                if (name == "get")
+                    cfg.w_get = w;
+                else if (name == "set")
+                    cfg.w_set = w;
+                else if (name == "lpush")
+                    cfg.w_lpush = w;
+                else if (name == "hset")
+                    cfg.w_hset = w;
+            }
+        }
+        else
+        {
+            std::cerr << "Unknown option: " << arg << "\n";
+            return 1;
+        }
+    }
+
+    if (cfg.w_get + cfg.w_set + cfg.w_lpush + cfg.w_hset <= 0)
     {
-        threads.emplace_back(clientWorker, i + 1, host, port, ops, mode, &stats);
+        std::cerr << "Empty command mix\n";
+        return 1;
     }
 
+    std::cout << "=== FlashKv Benchmark ===\n"
+              << "Clients:   " << cfg.clients << "\n"
+              << "Ops/client:" << cfg.ops << " (+" << cfg.warmup << " warmup)\n"
+              << "Pipeline:  " << cfg.pipeline << "\n"
+              << "Key space: " << cfg.keyspace << "\n"
+              << "Val size:  " << cfg.valsize_min << ".." << cfg.valsize_max << "\n"
+              << "Mix:       get:" << cfg.w_get << " set:" << cfg.w_set
+              << " lpush:" << cfg.w_lpush << " hset:" << cfg.w_hset << "\n\n";
+
+    std::vector<WorkerResult> results(cfg.clients);
+    std::vector<std::thread> threads;
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < cfg.clients; i++)
+        threads.emplace_back(clientWorker, i + 1, std::cref(cfg), &results[i]);
+
     for (auto &t : threads)
         t.join();
 
-    auto end = std::chrono::high_resolution_clock::now();
-
+    auto end = std::chrono::steady_clock::now();
     double sec = std::chrono::duration<double>(end - start).count();
-    long long totalOps = stats.totalOps.load();
 
-    std::cout << "Total ops: " << totalOps << "\n";
-    std::cout << "Time: " << sec << " sec\n";
-    std::cout << "OPS/sec: " << (totalOps / sec) << "\n";
+    long long totalOps = 0;
+    int failures = 0;
+    std::vector<uint64_t> all;
 
-    if (totalOps > 0)
+    for (auto &r : results)
     {
-        double avgLatencyMs = (stats.totalLatencyMicro / 1000.0) / totalOps;
-        std::cout << "Avg Latency: " << avgLatencyMs << " ms\n";
+        totalOps += r.ops_done;
+        if (r.failed)
+            failures++;
+        all.insert(all.end(), r.latencies_us.begin(), r.latencies_us.end());
     }
 
-    std::cout << "Timeouts: " << stats.timeouts << "\n";
-    std::cout << "Failures: " << stats.failures << "\n";
+    std::sort(all.begin(), all.end());
+
+    double opsPerSec = (sec > 0) ? totalOps / sec : 0;
+    uint64_t p50 = percentile(all, 0.50);
+    uint64_t p99 = percentile(all, 0.99);
+    uint64_t p999 = percentile(all, 0.999);
+    uint64_t pmax = all.empty() ? 0 : all.back();
+
+    std::cout << "Total ops: " << totalOps << "\n"
+              << "Time:      " << sec << " sec\n"
+              << "OPS/sec:   " << (long long)opsPerSec << "\n"
+              << "Latency (per batch of " << cfg.pipeline << "):\n"
+              << "  p50:   " << p50 << " us\n"
+              << "  p99:   " << p99 << " us\n"
+              << "  p99.9: " << p999 << " us\n"
+              << "  max:   " << pmax << " us\n"
+              << "Failed clients: " << failures << "\n"
+              << "=========================\n";
+
+    if (!cfg.csv.empty())
+    {
+        bool fresh = !std::ifstream(cfg.csv).good();
+        std::ofstream csv(cfg.csv, std::ios::app);
+        if (fresh)
+            csv << "clients,ops,pipeline,keys,valmin,valmax,"
+                   "get,set,lpush,hset,ops_per_sec,p50_us,p99_us,p999_us,max_us\n";
+        csv << cfg.clients << ',' << cfg.ops << ',' << cfg.pipeline << ','
+            << cfg.keyspace << ',' << cfg.valsize_min << ',' << cfg.valsize_max << ','
+            << cfg.w_get << ',' << cfg.w_set << ',' << cfg.w_lpush << ',' << cfg.w_hset << ','
+            << (long long)opsPerSec << ',' << p50 << ',' << p99 << ',' << p999 << ',' << pmax
+            << "\n";
+        std::cout << "Result row appended to " << cfg.csv << "\n";
+    }
 
-    std::cout << "=====================================\n";
-    return 0;
+    return failures ? 1 : 0;
 }